@@ -0,0 +1,133 @@
+#include "benchmark.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <regex>
+#include <sstream>
+
+/* Stop growing the number of iterations at this many. */
+#define MAX_ITERATIONS 1000000000
+
+static vector<unique_ptr<Benchmark>> &benchmarks() {
+  static vector<unique_ptr<Benchmark>> list;
+  return list;
+}
+
+Benchmark *register_benchmark(const string &name, BenchmarkFn fn) {
+  benchmarks().emplace_back(new Benchmark(name, fn));
+  return benchmarks().back().get();
+}
+
+double State::cpu_now() {
+  timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+void State::start() {
+  if (running) return;
+  running = true;
+  real_start = Clock::now();
+  cpu_start = cpu_now();
+}
+
+void State::stop() {
+  if (!running) return;
+  running = false;
+  real_time += chrono::duration<double>(Clock::now() - real_start).count();
+  cpu_time += cpu_now() - cpu_start;
+}
+
+static void help(char *name) {
+  cout << "usage: Run the microbenchmarks of the core kernels." << endl
+       << "\t" << name << " [OPTIONS]" << endl
+       << endl
+       << "optional arguments:" << endl
+       << "\t-h, --help              show this help message and exit" << endl
+       << "\t--filter=REGEX          only run the benchmarks whose name "
+          "matches REGEX"
+       << endl
+       << "\t--min-time=SECONDS      minimum time of each benchmark (default "
+          "0.5)"
+       << endl
+       << "\t--csv                   print the results as csv" << endl;
+  exit(EXIT_SUCCESS);
+}
+
+/* Run the benchmark with more iterations until it takes at least min_time. */
+static State run(const Benchmark &bench, const vector<int64_t> &args,
+                 double min_time) {
+  uint64_t iterations = 1;
+  while (true) {
+    State state(args, iterations);
+    bench.get_fn()(state);
+    double time = state.get_real_time();
+    if (time >= min_time || iterations >= MAX_ITERATIONS) return state;
+    /* Aim a bit above the minimum time, growing at most 10 times. */
+    double factor = (time > 0) ? 1.4 * min_time / time : 10;
+    factor = min(max(factor, 2.0), 10.0);
+    iterations = min<uint64_t>(iterations * factor, MAX_ITERATIONS);
+  }
+}
+
+int main(int argc, char *argv[]) {
+  string filter = ".*";
+  double min_time = 0.5;
+  bool csv = false;
+
+  for (int i = 1; i < argc; ++i) {
+    if (strncmp(argv[i], "--filter=", 9) == 0) {
+      filter = argv[i] + 9;
+    } else if (strncmp(argv[i], "--min-time=", 11) == 0) {
+      min_time = atof(argv[i] + 11);
+    } else if (strcmp(argv[i], "--csv") == 0) {
+      csv = true;
+    } else {
+      help(argv[0]);
+    }
+  }
+  regex re(filter);
+
+  if (csv) {
+    cout << "name,iterations,real_time_ns,cpu_time_ns,items_per_second"
+         << endl;
+  } else {
+    cout << left << setw(40) << "Benchmark" << right << setw(15) << "Time"
+         << setw(15) << "CPU" << setw(13) << "Iterations" << endl;
+    cout << string(83, '-') << endl;
+  }
+  for (auto &bench : benchmarks()) {
+    vector<vector<int64_t>> arg_lists = bench->get_arg_lists();
+    if (arg_lists.empty()) arg_lists.push_back({});
+    for (auto &args : arg_lists) {
+      ostringstream name;
+      name << bench->get_name();
+      for (int64_t a : args) name << "/" << a;
+      if (!regex_search(name.str(), re)) continue;
+
+      State state = run(*bench, args, min_time);
+      double n = state.get_iterations();
+      double real_ns = state.get_real_time() * 1e9 / n;
+      double cpu_ns = state.get_cpu_time() * 1e9 / n;
+      double rate = (state.get_items() > 0 && state.get_real_time() > 0)
+                        ? state.get_items() / state.get_real_time()
+                        : 0;
+      if (csv) {
+        cout << name.str() << "," << state.get_iterations() << "," << fixed
+             << setprecision(1) << real_ns << "," << cpu_ns << ","
+             << setprecision(0) << rate << endl;
+      } else {
+        cout << left << setw(40) << name.str() << right << fixed
+             << setprecision(0) << setw(12) << real_ns << " ns" << setw(12)
+             << cpu_ns << " ns" << setw(13) << state.get_iterations();
+        if (rate > 0) cout << "   " << setprecision(3) << rate << " items/s";
+        cout << endl;
+      }
+    }
+  }
+  return 0;
+}
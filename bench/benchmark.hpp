@@ -0,0 +1,96 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <vector>
+using namespace std;
+
+/* Minimal microbenchmark harness in the style of Google Benchmark. A
+ * benchmark is a function that runs its kernel while keep_running returns
+ * true, it is registered with the BENCHMARK macro and run for each list of
+ * arguments given to it:
+ *
+ *   void bench_kernel(State &state) {
+ *     Input input = setup(state.range(0));
+ *     while (state.keep_running()) kernel(input);
+ *   }
+ *   BENCHMARK(bench_kernel)->args({100})->args({1000});
+ *
+ * The number of iterations grows until the kernel runs for a minimum time.
+ */
+
+/* Keep the compiler from optimizing a value away. */
+template <class T> inline void do_not_optimize(const T &value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+class State {
+  typedef chrono::steady_clock Clock;
+
+  vector<int64_t> arguments;
+  uint64_t iterations;
+  uint64_t done = 0;
+  bool running = false;
+  Clock::time_point real_start;
+  double cpu_start = 0;
+  double real_time = 0;
+  double cpu_time = 0;
+  int64_t items = 0;
+
+  static double cpu_now();
+  void start();
+  void stop();
+
+ public:
+  State(const vector<int64_t> &arguments, uint64_t iterations)
+      : arguments(arguments), iterations(iterations) {}
+  int64_t range(size_t i) const { return arguments.at(i); }
+  /* Whether the kernel must run once more, the time is measured from the
+   * first call to the last one. */
+  bool keep_running() {
+    if (done == 0) start();
+    if (done < iterations) {
+      done++;
+      return true;
+    }
+    stop();
+    return false;
+  }
+  /* Exclude the setup of an iteration from the time. */
+  void pause_timing() { stop(); }
+  void resume_timing() { start(); }
+  /* Number of items processed by all the iterations, to report a rate. */
+  void set_items_processed(int64_t n) { items = n; }
+  uint64_t get_iterations() const { return iterations; }
+  double get_real_time() const { return real_time; }
+  double get_cpu_time() const { return cpu_time; }
+  int64_t get_items() const { return items; }
+};
+
+typedef void (*BenchmarkFn)(State &);
+
+class Benchmark {
+  string name;
+  BenchmarkFn fn;
+  vector<vector<int64_t>> arg_lists;
+
+ public:
+  Benchmark(const string &name, BenchmarkFn fn) : name(name), fn(fn) {}
+  /* Run the benchmark with one more list of arguments. */
+  Benchmark *args(const vector<int64_t> &a) {
+    arg_lists.push_back(a);
+    return this;
+  }
+  const string &get_name() const { return name; }
+  BenchmarkFn get_fn() const { return fn; }
+  const vector<vector<int64_t>> &get_arg_lists() const { return arg_lists; }
+};
+
+Benchmark *register_benchmark(const string &name, BenchmarkFn fn);
+
+#define BENCHMARK_CONCAT(a, b) a##b
+#define BENCHMARK_VAR(line) BENCHMARK_CONCAT(benchmark_, line)
+#define BENCHMARK(fn) \
+  static Benchmark *BENCHMARK_VAR(__LINE__) = register_benchmark(#fn, fn)
@@ -0,0 +1,207 @@
+#include "json.hpp"
+
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+const Json *Json::get(const string &key) const {
+  for (auto &member : object) {
+    if (member.first == key) return &member.second;
+  }
+  return nullptr;
+}
+
+Json &Json::set(const string &key, Json value) {
+  object.emplace_back(key, move(value));
+  return object.back().second;
+}
+
+static void write_string(ostream &os, const string &s) {
+  os << '"';
+  for (char c : s) {
+    switch (c) {
+    case '"':
+      os << "\\\"";
+      break;
+    case '\\':
+      os << "\\\\";
+      break;
+    case '\n':
+      os << "\\n";
+      break;
+    case '\t':
+      os << "\\t";
+      break;
+    default:
+      if ((unsigned char)c < 0x20) {
+        os << "\\u" << hex << setw(4) << setfill('0') << int(c) << dec
+           << setfill(' ');
+      } else {
+        os << c;
+      }
+    }
+  }
+  os << '"';
+}
+
+void Json::write(ostream &os, int indent) const {
+  string pad(indent + 2, ' ');
+  switch (type) {
+  case NUL:
+    os << "null";
+    break;
+  case BOOL:
+    os << (boolean ? "true" : "false");
+    break;
+  case NUMBER:
+    if (std::isfinite(number)) {
+      os << setprecision(10) << number;
+    } else {
+      os << "null";
+    }
+    break;
+  case STRING:
+    write_string(os, str);
+    break;
+  case ARRAY:
+    if (array.empty()) {
+      os << "[]";
+      break;
+    }
+    os << "[\n";
+    for (size_t i = 0; i < array.size(); ++i) {
+      os << pad;
+      array[i].write(os, indent + 2);
+      os << (i + 1 < array.size() ? ",\n" : "\n");
+    }
+    os << string(indent, ' ') << "]";
+    break;
+  case OBJECT:
+    if (object.empty()) {
+      os << "{}";
+      break;
+    }
+    os << "{\n";
+    for (size_t i = 0; i < object.size(); ++i) {
+      os << pad;
+      write_string(os, object[i].first);
+      os << ": ";
+      object[i].second.write(os, indent + 2);
+      os << (i + 1 < object.size() ? ",\n" : "\n");
+    }
+    os << string(indent, ' ') << "}";
+    break;
+  }
+}
+
+class JsonParser {
+  istream &is;
+
+  [[noreturn]] void fail(const string &msg) {
+    throw invalid_argument("Invalid JSON: " + msg + ".");
+  }
+  int peek() {
+    is >> ws;
+    return is.peek();
+  }
+  void expect(char c) {
+    if (peek() != c) fail(string("expected '") + c + "'");
+    is.get();
+  }
+  void literal(const string &word) {
+    for (char c : word) {
+      if (is.get() != c) fail("expected " + word);
+    }
+  }
+
+  string parse_string() {
+    expect('"');
+    string s;
+    for (int c = is.get(); c != '"'; c = is.get()) {
+      if (c == EOF) fail("unterminated string");
+      if (c == '\\') {
+        c = is.get();
+        switch (c) {
+        case 'n':
+          s += '\n';
+          break;
+        case 't':
+          s += '\t';
+          break;
+        case 'r':
+          s += '\r';
+          break;
+        case 'b':
+          s += '\b';
+          break;
+        case 'f':
+          s += '\f';
+          break;
+        case 'u': {
+          /* Only the characters written by Json::write are expected. */
+          char hex_digits[5] = {0};
+          is.read(hex_digits, 4);
+          s += char(strtol(hex_digits, nullptr, 16));
+          break;
+        }
+        default:
+          s += char(c);
+        }
+      } else {
+        s += char(c);
+      }
+    }
+    return s;
+  }
+
+ public:
+  JsonParser(istream &is) : is(is) {}
+
+  Json parse() {
+    int c = peek();
+    if (c == '{') {
+      Json j = Json::make_object();
+      is.get();
+      if (peek() == '}') {
+        is.get();
+        return j;
+      }
+      do {
+        string key = parse_string();
+        expect(':');
+        j.set(key, parse());
+      } while (peek() == ',' && is.get());
+      expect('}');
+      return j;
+    } else if (c == '[') {
+      Json j = Json::make_array();
+      is.get();
+      if (peek() == ']') {
+        is.get();
+        return j;
+      }
+      do {
+        j.array.push_back(parse());
+      } while (peek() == ',' && is.get());
+      expect(']');
+      return j;
+    } else if (c == '"') {
+      return Json(parse_string());
+    } else if (c == 't') {
+      literal("true");
+      return Json(true);
+    } else if (c == 'f') {
+      literal("false");
+      return Json(false);
+    } else if (c == 'n') {
+      literal("null");
+      return Json();
+    }
+    double x;
+    if (!(is >> x)) fail("unexpected character");
+    return Json(x);
+  }
+};
+
+Json parse_json(istream &is) { return JsonParser(is).parse(); }
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+using namespace std;
+
+/* JSON value, enough to write the reports and read them back. */
+struct Json {
+  enum Type { NUL, BOOL, NUMBER, STRING, ARRAY, OBJECT };
+
+  Type type = NUL;
+  bool boolean = false;
+  double number = 0;
+  string str;
+  vector<Json> array;
+  vector<pair<string, Json>> object;
+
+  Json() {}
+  Json(bool b) : type(BOOL), boolean(b) {}
+  Json(double x) : type(NUMBER), number(x) {}
+  Json(int x) : Json(double(x)) {}
+  Json(long x) : Json(double(x)) {}
+  Json(unsigned long x) : Json(double(x)) {}
+  Json(const string &s) : type(STRING), str(s) {}
+  Json(const char *s) : Json(string(s)) {}
+  static Json make_array() {
+    Json j;
+    j.type = ARRAY;
+    return j;
+  }
+  static Json make_object() {
+    Json j;
+    j.type = OBJECT;
+    return j;
+  }
+
+  /* Member of an object, nullptr if there is none. */
+  const Json *get(const string &key) const;
+  /* Add a member to an object. */
+  Json &set(const string &key, Json value);
+  void write(ostream &os, int indent = 0) const;
+};
+
+/* Throws invalid_argument if the text is not valid JSON. */
+Json parse_json(istream &is);
@@ -0,0 +1,474 @@
+#include <algorithm>
+#include <cmath>
+#include <experimental/filesystem>
+#include <fstream>
+#include <getopt.h>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <regex>
+#include <sstream>
+
+#include "../../misc/io.hpp"
+#include "json.hpp"
+#include "process.hpp"
+namespace fs = experimental::filesystem;
+using namespace std;
+
+#define N_POS_ARGS 1
+
+struct Args {
+  string mode;
+  string db = "db";
+  string match = ".";
+  int instances = 5;
+  vector<string> algs = {"dec:rand", "dec:ga", "dist:reversal",
+                         "dist:reversal_transposition"};
+  string bin = ".";
+  int iterations = 100;
+  uint64_t seed = 1;
+  int threads = 1;
+  string output;
+  string format = "json";
+  double threshold = 0.1;
+  vector<string> reports;
+};
+
+/* Measurements of one run of a program over one instance. */
+struct Record {
+  string file;
+  string group; // folder of the file (SREV25...)
+  size_t instance;
+  string alg;   // program:algorithm
+  int status;
+  double wall;
+  double cpu;
+  long max_rss;
+  long iterations;
+  double objective; // NaN if it could not be read
+};
+
+void help(char *name) {
+  cout << "usage: Benchmark dec and dist over the simulated genomes and "
+          "report the time, memory and objective of each instance."
+       << endl
+       << "\t" << name << " run [OPTIONS]" << endl
+       << "\t" << name << " compare OLD NEW [-T THRESHOLD]" << endl
+       << endl
+       << "positional arguments:" << endl
+       << "\tMODE     run the benchmark, or compare two json reports "
+          "(exits with 1 if the mean cpu time of a group grew more than the "
+          "threshold)"
+       << endl
+       << endl
+       << "optional arguments:" << endl
+       << "\t-h, --help              show this help message and exit" << endl
+       << "\t-d, --db DIR            folder with the instances (default db)"
+       << endl
+       << "\t-m, --match REGEX       only use the files whose path inside "
+          "the folder matches REGEX (default all)"
+       << endl
+       << "\t-n, --instances N       instances of each file (default 5, 0 for "
+          "all)"
+       << endl
+       << "\t-a, --algs LIST         comma separated list of program:algorithm "
+          "(default dec:rand,dec:ga,dist:reversal,dist:reversal_transposition)"
+       << endl
+       << "\t-b, --bin DIR           folder with the dec and dist "
+          "executables (default .)"
+       << endl
+       << "\t-k, --iterations ITER   iterations of each run (default 100)"
+       << endl
+       << "\t-s, --seed SEED         seed of every run (default 1)" << endl
+       << "\t-j, --threads N         threads of each run (default 1)" << endl
+       << "\t-o, --output FILE       report file (default stdout)" << endl
+       << "\t-f, --format FORMAT     json or csv (default json)" << endl
+       << "\t-T, --threshold FRAC    relative growth of the time taken as a "
+          "regression by compare (default 0.1)"
+       << endl;
+
+  exit(EXIT_SUCCESS);
+}
+
+void get_args(Args &args, int argc, char *argv[]) {
+  extern char *optarg;
+  extern int optind;
+  vector<string> pos_args;
+
+  struct option longopts[] = {
+      {"db", 1, NULL, 'd'},        {"match", 1, NULL, 'm'},
+      {"instances", 1, NULL, 'n'}, {"algs", 1, NULL, 'a'},
+      {"bin", 1, NULL, 'b'},       {"iterations", 1, NULL, 'k'},
+      {"seed", 1, NULL, 's'},      {"threads", 1, NULL, 'j'},
+      {"output", 1, NULL, 'o'},    {"format", 1, NULL, 'f'},
+      {"threshold", 1, NULL, 'T'}, {"help", 0, NULL, 'h'},
+      {0, 0, 0, 0}};
+
+  char op;
+  while ((op = getopt_long(argc, argv, "d:m:n:a:b:k:s:j:o:f:T:h", longopts,
+                           NULL)) != -1) {
+    switch (op) {
+    case 'd':
+      args.db = optarg;
+      break;
+    case 'm':
+      args.match = optarg;
+      break;
+    case 'n':
+      args.instances = atoi(optarg);
+      break;
+    case 'a': {
+      stringstream ss(optarg);
+      string alg;
+      args.algs.clear();
+      while (getline(ss, alg, ',')) {
+        if (alg != "") args.algs.push_back(alg);
+      }
+      break;
+    }
+    case 'b':
+      args.bin = optarg;
+      break;
+    case 'k':
+      args.iterations = atoi(optarg);
+      break;
+    case 's':
+      args.seed = strtoull(optarg, NULL, 10);
+      break;
+    case 'j':
+      args.threads = atoi(optarg);
+      break;
+    case 'o':
+      args.output = optarg;
+      break;
+    case 'f':
+      args.format = optarg;
+      break;
+    case 'T':
+      args.threshold = atof(optarg);
+      break;
+    default:
+      help(argv[0]);
+    }
+  }
+  for (int i = optind; i < argc; i++) {
+    pos_args.push_back(argv[i]);
+  }
+
+  if (pos_args.size() < N_POS_ARGS) {
+    help(argv[0]);
+  }
+  args.mode = pos_args[0];
+  args.reports.assign(pos_args.begin() + 1, pos_args.end());
+  if (args.mode == "compare" && args.reports.size() != 2) {
+    help(argv[0]);
+  }
+  if (args.mode != "compare" && (args.mode != "run" || !args.reports.empty())) {
+    help(argv[0]);
+  }
+  if (args.format != "json" && args.format != "csv") {
+    help(argv[0]);
+  }
+  for (auto &alg : args.algs) {
+    if (alg.compare(0, 4, "dec:") != 0 && alg.compare(0, 5, "dist:") != 0) {
+      help(argv[0]);
+    }
+  }
+}
+
+/* Files of the corpus whose relative path matches, in a fixed order. */
+vector<fs::path> corpus_files(const Args &args) {
+  vector<fs::path> files;
+  regex re(args.match);
+  for (auto &entry : fs::recursive_directory_iterator(args.db)) {
+    fs::path path = entry.path();
+    if (!fs::is_regular_file(path) || path.extension() != ".txt") continue;
+    string rel = path.string().substr(fs::path(args.db).string().size());
+    if (regex_search(rel, re)) files.push_back(path);
+  }
+  sort(files.begin(), files.end());
+  return files;
+}
+
+/* Number after "name: " in the text, NaN if there is none. */
+double read_field(const string &text, const string &name) {
+  size_t p = text.rfind(name + ": ");
+  if (p == string::npos) return NAN;
+  return atof(text.c_str() + p + name.size() + 2);
+}
+
+/* Instance for dist made by dec: the strings mapped by a decomposition. */
+string mapped_instance(const Args &args, const string &instance) {
+  ProcessResult r = run_process(
+      {args.bin + "/dec", "rand", "-k", "1", "-s", to_string(args.seed)},
+      instance, {"OMP_NUM_THREADS=1"});
+  istringstream is(r.output);
+  string mapped;
+  for (string line; getline(is, line);) {
+    if (line.compare(0, 4, "Dec:") != 0 && line.find('(') == string::npos) {
+      mapped += line + "\n";
+    }
+  }
+  return mapped;
+}
+
+Record run_instance(const Args &args, const string &alg,
+                    const string &instance) {
+  size_t colon = alg.find(':');
+  string prog = alg.substr(0, colon);
+  string name = alg.substr(colon + 1);
+  string input = (prog == "dist") ? mapped_instance(args, instance) : instance;
+
+  ProcessResult r = run_process(
+      {args.bin + "/" + prog, name, "-k", to_string(args.iterations), "-s",
+       to_string(args.seed)},
+      input, {"OMP_NUM_THREADS=" + to_string(args.threads)});
+
+  Record rec;
+  rec.alg = alg;
+  rec.status = r.status;
+  rec.wall = r.wall;
+  rec.cpu = r.cpu;
+  rec.max_rss = r.max_rss;
+  if (prog == "dec") {
+    rec.objective = read_field(r.output, "Objective");
+    double it = read_field(r.output, "Iterations");
+    rec.iterations = std::isnan(it) ? 0 : long(it);
+  } else {
+    /* The last distance is the best one. */
+    rec.objective = read_field(r.output, "Dist");
+    rec.iterations = args.iterations;
+  }
+  return rec;
+}
+
+struct Stats {
+  size_t count = 0;
+  double mean = NAN, median = NAN, min = NAN, max = NAN, stddev = NAN;
+};
+
+Stats stats(vector<double> xs) {
+  Stats s;
+  xs.erase(remove_if(xs.begin(), xs.end(),
+                     [](double x) { return std::isnan(x); }),
+           xs.end());
+  s.count = xs.size();
+  if (xs.empty()) return s;
+  sort(xs.begin(), xs.end());
+  double sum = 0;
+  for (double x : xs) sum += x;
+  s.mean = sum / xs.size();
+  s.median = (xs.size() % 2) ? xs[xs.size() / 2]
+                             : (xs[xs.size() / 2 - 1] + xs[xs.size() / 2]) / 2;
+  s.min = xs.front();
+  s.max = xs.back();
+  double sq = 0;
+  for (double x : xs) sq += (x - s.mean) * (x - s.mean);
+  s.stddev = sqrt(sq / xs.size());
+  return s;
+}
+
+Json stats_json(const Stats &s) {
+  Json j = Json::make_object();
+  j.set("mean", s.mean);
+  j.set("median", s.median);
+  j.set("min", s.min);
+  j.set("max", s.max);
+  j.set("stddev", s.stddev);
+  return j;
+}
+
+/* Statistics of each algorithm on each group of files. */
+Json summarize(const vector<Record> &records) {
+  map<pair<string, string>, vector<const Record *>> groups;
+  for (auto &rec : records) {
+    groups[{rec.alg, rec.group}].push_back(&rec);
+  }
+  Json summary = Json::make_array();
+  for (auto &g : groups) {
+    vector<double> wall, cpu, rss, objective;
+    int failed = 0;
+    for (const Record *rec : g.second) {
+      if (rec->status != 0) {
+        failed++;
+        continue;
+      }
+      wall.push_back(rec->wall);
+      cpu.push_back(rec->cpu);
+      rss.push_back(rec->max_rss);
+      objective.push_back(rec->objective);
+    }
+    Json j = Json::make_object();
+    j.set("alg", g.first.first);
+    j.set("group", g.first.second);
+    j.set("count", g.second.size());
+    j.set("failed", failed);
+    j.set("wall", stats_json(stats(wall)));
+    j.set("cpu", stats_json(stats(cpu)));
+    j.set("max_rss_kb", stats_json(stats(rss)));
+    j.set("objective", stats_json(stats(objective)));
+    summary.array.push_back(move(j));
+  }
+  return summary;
+}
+
+void print_summary(ostream &os, const Json &summary) {
+  os << left << setw(32) << "alg" << setw(16) << "group" << right << setw(6)
+     << "n" << setw(12) << "wall(s)" << setw(12) << "cpu(s)" << setw(12)
+     << "rss(kB)" << setw(12) << "objective" << endl;
+  os << fixed;
+  for (auto &g : summary.array) {
+    os << left << setw(32) << g.get("alg")->str << setw(16)
+       << g.get("group")->str << right << setw(6)
+       << int(g.get("count")->number) << setprecision(4) << setw(12)
+       << g.get("wall")->get("mean")->number << setw(12)
+       << g.get("cpu")->get("mean")->number << setprecision(0) << setw(12)
+       << g.get("max_rss_kb")->get("max")->number << setprecision(2)
+       << setw(12) << g.get("objective")->get("mean")->number << endl;
+  }
+}
+
+void write_report(const Args &args, const vector<Record> &records,
+                  const Json &summary, ostream &os) {
+  if (args.format == "csv") {
+    os << "file,group,instance,alg,status,wall,cpu,max_rss_kb,iterations,"
+          "objective"
+       << endl;
+    for (auto &rec : records) {
+      os << rec.file << "," << rec.group << "," << rec.instance << ","
+         << rec.alg << "," << rec.status << "," << rec.wall << "," << rec.cpu
+         << "," << rec.max_rss << "," << rec.iterations << ",";
+      if (!std::isnan(rec.objective)) os << rec.objective;
+      os << endl;
+    }
+    return;
+  }
+
+  Json report = Json::make_object();
+  Json &config = report.set("config", Json::make_object());
+  config.set("db", args.db);
+  config.set("match", args.match);
+  config.set("instances", args.instances);
+  config.set("iterations", args.iterations);
+  config.set("seed", to_string(args.seed));
+  config.set("threads", args.threads);
+  Json &results = report.set("results", Json::make_array());
+  for (auto &rec : records) {
+    Json j = Json::make_object();
+    j.set("file", rec.file);
+    j.set("group", rec.group);
+    j.set("instance", rec.instance);
+    j.set("alg", rec.alg);
+    j.set("status", rec.status);
+    j.set("wall", rec.wall);
+    j.set("cpu", rec.cpu);
+    j.set("max_rss_kb", rec.max_rss);
+    j.set("iterations", rec.iterations);
+    j.set("objective", rec.objective);
+    results.array.push_back(move(j));
+  }
+  report.set("summary", summary);
+  report.write(os);
+  os << endl;
+}
+
+void run(const Args &args) {
+  vector<Record> records;
+  for (auto &file : corpus_files(args)) {
+    ifstream is(file);
+    InstanceReader reader(is, 2);
+    vector<string> lines;
+    for (size_t i = 0;
+         (args.instances == 0 || i < size_t(args.instances)) &&
+         reader.next(lines);
+         ++i) {
+      string instance = lines[0] + "\n" + lines[1] + "\n";
+      for (auto &alg : args.algs) {
+        Record rec = run_instance(args, alg, instance);
+        rec.file = file.string();
+        rec.group = file.parent_path().filename().string();
+        rec.instance = i;
+        cerr << rec.file << " " << i << " " << alg << ": " << rec.wall
+             << "s" << endl;
+        records.push_back(move(rec));
+      }
+    }
+  }
+
+  Json summary = summarize(records);
+  print_summary(cerr, summary);
+  if (args.output != "") {
+    ofstream os(args.output);
+    if (!os) throw invalid_argument("Could not open " + args.output + ".");
+    write_report(args, records, summary, os);
+  } else {
+    write_report(args, records, summary, cout);
+  }
+}
+
+Json load_report(const string &file) {
+  ifstream is(file);
+  if (!is) throw invalid_argument("Could not open " + file + ".");
+  Json report = parse_json(is);
+  if (report.get("summary") == nullptr) {
+    throw invalid_argument(file + " is not a json report.");
+  }
+  return report;
+}
+
+/* Compare the summaries of two reports, return whether some group got
+ * slower than the threshold. */
+bool compare(const Args &args) {
+  Json old_report = load_report(args.reports[0]);
+  Json new_report = load_report(args.reports[1]);
+  map<pair<string, string>, const Json *> old_groups;
+  for (auto &g : old_report.get("summary")->array) {
+    old_groups[{g.get("alg")->str, g.get("group")->str}] = &g;
+  }
+
+  auto change = [](const Json &o, const Json &n, const string &field) {
+    return n.get(field)->get("mean")->number /
+               o.get(field)->get("mean")->number -
+           1;
+  };
+  bool regression = false;
+  cout << left << setw(32) << "alg" << setw(16) << "group" << right
+       << setw(12) << "wall" << setw(12) << "cpu" << setw(12) << "rss"
+       << setw(22) << "objective" << endl;
+  cout << fixed << showpos;
+  for (auto &n : new_report.get("summary")->array) {
+    auto it = old_groups.find({n.get("alg")->str, n.get("group")->str});
+    if (it == old_groups.end()) continue;
+    const Json &o = *it->second;
+    double cpu = change(o, n, "cpu");
+    bool slower = cpu > args.threshold;
+    regression = regression || slower;
+    cout << left << setw(32) << n.get("alg")->str << setw(16)
+         << n.get("group")->str << right << setprecision(1) << setw(11)
+         << 100 * change(o, n, "wall") << "%" << setw(11) << 100 * cpu << "%"
+         << setw(11) << 100 * change(o, n, "max_rss_kb") << "%" << noshowpos
+         << setprecision(2) << setw(10) << o.get("objective")->get("mean")->number
+         << " -> " << setw(8) << n.get("objective")->get("mean")->number
+         << showpos << (slower ? "  slower" : "") << endl;
+  }
+  return regression;
+}
+
+int main(int argc, char *argv[]) {
+  Args args;
+
+  get_args(args, argc, argv);
+
+  try {
+    if (args.mode == "compare") {
+      return compare(args) ? 1 : 0;
+    }
+    run(args);
+  } catch (const exception &e) {
+    cerr << "Something went wrong!!!" << endl;
+    cerr << e.what() << endl;
+    return 2;
+  }
+
+  return 0;
+}
@@ -0,0 +1,109 @@
+#include "process.hpp"
+
+#include <chrono>
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdexcept>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+ProcessResult run_process(const vector<string> &argv, const string &input,
+                          const vector<string> &env) {
+  ProcessResult result;
+  int to_child[2], from_child[2];
+  if (pipe2(to_child, O_CLOEXEC) != 0) {
+    throw runtime_error("Could not create pipe.");
+  }
+  if (pipe2(from_child, O_CLOEXEC) != 0) {
+    close(to_child[0]);
+    close(to_child[1]);
+    throw runtime_error("Could not create pipe.");
+  }
+  /* A child that exits early must not kill us when we write to it. */
+  signal(SIGPIPE, SIG_IGN);
+
+  auto start = chrono::steady_clock::now();
+  pid_t pid = fork();
+  if (pid == 0) {
+    dup2(to_child[0], STDIN_FILENO);
+    dup2(from_child[1], STDOUT_FILENO);
+    int null = open("/dev/null", O_WRONLY);
+    if (null >= 0) dup2(null, STDERR_FILENO);
+    for (auto &var : env) {
+      putenv(strdup(var.c_str()));
+    }
+    vector<char *> args;
+    for (auto &a : argv) args.push_back(const_cast<char *>(a.c_str()));
+    args.push_back(nullptr);
+    execv(args[0], args.data());
+    _exit(127);
+  }
+  close(to_child[0]);
+  close(from_child[1]);
+  if (pid < 0) {
+    close(to_child[1]);
+    close(from_child[0]);
+    throw runtime_error("Could not start " + argv[0] + ".");
+  }
+
+  /* Write the input and read the output at the same time, so neither side
+   * blocks on a full pipe. */
+  size_t written = 0;
+  int in_fd = to_child[1];
+  if (input.empty()) {
+    close(in_fd);
+    in_fd = -1;
+  }
+  fcntl(from_child[0], F_SETFL, O_NONBLOCK);
+  char buf[1 << 16];
+  while (true) {
+    pollfd fds[2];
+    int n = 0;
+    fds[n++] = pollfd{from_child[0], POLLIN, 0};
+    if (in_fd >= 0) fds[n++] = pollfd{in_fd, POLLOUT, 0};
+    if (poll(fds, n, -1) < 0) {
+      if (errno == EINTR) continue;
+      int err = errno;
+      kill(pid, SIGKILL);
+      waitpid(pid, nullptr, 0);
+      if (in_fd >= 0) close(in_fd);
+      close(from_child[0]);
+      throw runtime_error("Could not wait for " + argv[0] + ": " +
+                          strerror(err) + ".");
+    }
+    if (in_fd >= 0 && (fds[1].revents & (POLLOUT | POLLERR | POLLHUP))) {
+      ssize_t w = write(in_fd, input.data() + written, input.size() - written);
+      if (w > 0) written += w;
+      if (w < 0 || written == input.size()) {
+        close(in_fd);
+        in_fd = -1;
+      }
+    }
+    if (fds[0].revents & (POLLIN | POLLHUP | POLLERR)) {
+      ssize_t r = read(from_child[0], buf, sizeof(buf));
+      if (r > 0) {
+        result.output.append(buf, r);
+      } else if (r == 0) {
+        break;
+      }
+    }
+  }
+  if (in_fd >= 0) close(in_fd);
+  close(from_child[0]);
+
+  int status;
+  rusage usage;
+  wait4(pid, &status, 0, &usage);
+  result.wall =
+      chrono::duration<double>(chrono::steady_clock::now() - start).count();
+  result.cpu = usage.ru_utime.tv_sec + usage.ru_utime.tv_usec * 1e-6 +
+               usage.ru_stime.tv_sec + usage.ru_stime.tv_usec * 1e-6;
+  result.max_rss = usage.ru_maxrss;
+  result.status = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+  return result;
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <string>
+#include <vector>
+using namespace std;
+
+/* Resources used by a child process. */
+struct ProcessResult {
+  int status = -1;    // exit status, or -1 if it did not exit normally
+  double wall = 0;    // seconds
+  double cpu = 0;     // user plus system seconds
+  long max_rss = 0;   // kilobytes
+  string output;      // stdout
+};
+
+/* Run a program with the given input in its stdin and the environment
+ * variables (NAME=VALUE) added to ours, wait for it and measure it with
+ * wait4. Throws runtime_error if the program could not be started. */
+ProcessResult run_process(const vector<string> &argv, const string &input,
+                          const vector<string> &env = {});
@@ -0,0 +1,341 @@
+#include <cstdlib>
+#include <memory>
+#include <numeric>
+
+#include "../cycle/cycles.hpp"
+#include "../heur/ga.hpp"
+#include "../misc/generator.hpp"
+#include "../misc/genome.hpp"
+#include "../misc/io.hpp"
+#include "../misc/permutation.hpp"
+#include "../misc/reduction_rules.hpp"
+#include "../misc/rng.hpp"
+#include "benchmark.hpp"
+#include "sorting.h"
+
+/* Instances with (length, alphabet size) as arguments, from the sizes of the
+ * db/ corpus up to longer genomes. */
+static Benchmark *with_sizes(Benchmark *bench) {
+  return bench->args({100, 10})
+      ->args({100, 100})
+      ->args({1000, 100})
+      ->args({1000, 1000})
+      ->args({10000, 1000})
+      ->args({10000, 10000});
+}
+
+#define BENCHMARK_SIZES(fn)                        \
+  static Benchmark *BENCHMARK_VAR(__LINE__) =      \
+      with_sizes(register_benchmark(#fn, fn))
+
+/* Finding a decomposition is quadratic in practice, it takes tens of seconds
+ * with 10000 genes, so the kernels that need one stop at 1000. */
+static Benchmark *with_decomposition_sizes(Benchmark *bench) {
+  return bench->args({100, 10})
+      ->args({100, 100})
+      ->args({1000, 100})
+      ->args({1000, 1000});
+}
+
+#define BENCHMARK_DECOMPOSITION_SIZES(fn)          \
+  static Benchmark *BENCHMARK_VAR(__LINE__) =      \
+      with_decomposition_sizes(register_benchmark(#fn, fn))
+
+/* Instance made like the ones of db/SREV25: length / 4 reversals, followed
+ * by a quarter of that of deletions and of insertions. Without deletions
+ * every gene of the origin can be mapped to the target. */
+static InputData make_instance(State &state, bool deletions = true) {
+  GeneratorParams params;
+  params.length = state.range(0);
+  params.alphabet = state.range(1);
+  params.reversals = params.length / 4;
+  params.deletions = deletions ? params.reversals / 4 : 0;
+  params.insertions = params.reversals / 4;
+  Rng rng(params.length, params.alphabet);
+  GeneratedInstance inst = generate_instance(params, rng);
+
+  InputData data;
+  data.g.reset(new Genome(inst.g.data(), inst.g.size(), nullptr, 0, true));
+  data.h.reset(new Genome(inst.h.data(), inst.h.size(), nullptr, 0, true));
+  return data;
+}
+
+static unique_ptr<CycleGraph> make_decomposition(const InputData &data,
+                                                 Rng &rng) {
+  unique_ptr<CycleGraph> cg(new CycleGraph(*data.g, *data.h));
+  cg->decompose_with_bfs(true, rng);
+  return cg;
+}
+
+void bench_cycle_graph(State &state) {
+  InputData data = make_instance(state);
+  while (state.keep_running()) {
+    CycleGraph cg(*data.g, *data.h);
+    do_not_optimize(cg.size());
+  }
+}
+BENCHMARK_SIZES(bench_cycle_graph);
+
+void bench_bfs(State &state) {
+  InputData data = make_instance(state);
+  CycleGraph cg(*data.g, *data.h);
+  Rng rng(0, 0);
+  while (state.keep_running()) {
+    state.pause_timing();
+    cg.reset();
+    state.resume_timing();
+    cg.bfs(0, true, rng);
+  }
+}
+BENCHMARK_SIZES(bench_bfs);
+
+void bench_decompose_with_bfs(State &state) {
+  InputData data = make_instance(state);
+  CycleGraph cg(*data.g, *data.h);
+  Rng rng(0, 0);
+  while (state.keep_running()) {
+    state.pause_timing();
+    cg.reset();
+    state.resume_timing();
+    cg.decompose_with_bfs(true, rng);
+  }
+}
+BENCHMARK_DECOMPOSITION_SIZES(bench_decompose_with_bfs);
+
+void bench_get_perms(State &state) {
+  InputData data = make_instance(state);
+  Rng rng(0, 0);
+  unique_ptr<CycleGraph> cg = make_decomposition(data, rng);
+  while (state.keep_running()) {
+    PermsIrs perms = cg->get_perms();
+    do_not_optimize(perms.s);
+    free(perms.s);
+    free(perms.s_ir);
+    free(perms.p);
+    free(perms.p_ir);
+  }
+}
+BENCHMARK_DECOMPOSITION_SIZES(bench_get_perms);
+
+void bench_cycle_weight_potation(State &state) {
+  InputData data = make_instance(state);
+  Rng rng(0, 0);
+  unique_ptr<CycleGraph> cg = make_decomposition(data, rng);
+  auto cycles = cg->cycle_list();
+  while (state.keep_running()) {
+    int sum = 0;
+    for (auto &c : cycles) {
+      sum += cg->cycle_weight(c.second) + cg->cycle_potation(c.second);
+    }
+    do_not_optimize(sum);
+  }
+  state.set_items_processed(state.get_iterations() * cycles.size());
+}
+BENCHMARK_DECOMPOSITION_SIZES(bench_cycle_weight_potation);
+
+/* Gives access to the operators of the genetic algorithm. */
+class BenchGA : public GA {
+ public:
+  using GA::GA;
+  using GA::crossover;
+  using GA::mutation;
+};
+
+static unique_ptr<BenchGA> make_ga(const CycleGraph &cg) {
+  return unique_ptr<BenchGA>(new BenchGA(new Chromossome(cg), 0.5, 0.5, 2, 2,
+                                         2, 0, nullptr, Timer(), 0));
+}
+
+void bench_ga_crossover(State &state) {
+  InputData data = make_instance(state);
+  CycleGraph cg(*data.g, *data.h);
+  unique_ptr<BenchGA> ga = make_ga(cg);
+  Rng rng(0, 0);
+  Chromossome parent1(cg), parent2(cg);
+  parent1.decompose_with_bfs(true, rng);
+  parent2.decompose_with_bfs(true, rng);
+  while (state.keep_running()) {
+    unique_ptr<Chromossome> child(ga->crossover(parent1, parent2, rng));
+    do_not_optimize(child->fitness());
+  }
+}
+BENCHMARK_DECOMPOSITION_SIZES(bench_ga_crossover);
+
+void bench_ga_mutation(State &state) {
+  InputData data = make_instance(state);
+  CycleGraph cg(*data.g, *data.h);
+  unique_ptr<BenchGA> ga = make_ga(cg);
+  Rng rng(0, 0);
+  Chromossome parent(cg);
+  parent.decompose_with_bfs(true, rng);
+  while (state.keep_running()) {
+    state.pause_timing();
+    unique_ptr<Chromossome> child(new Chromossome(parent));
+    state.resume_timing();
+    ga->mutation(child, rng);
+  }
+}
+BENCHMARK_DECOMPOSITION_SIZES(bench_ga_mutation);
+
+void bench_permutation_mapping(State &state) {
+  InputData data = make_instance(state, false);
+  Rng rng(0, 0);
+  while (state.keep_running()) {
+    Permutation pi(*data.g, *data.h, false, rng);
+    do_not_optimize(pi.size());
+  }
+}
+BENCHMARK_SIZES(bench_permutation_mapping);
+
+void bench_suboptimal_rule_interval(State &state) {
+  InputData data = make_instance(state);
+  while (state.keep_running()) {
+    state.pause_timing();
+    Genome g(*data.g), h(*data.h);
+    state.resume_timing();
+    suboptimal_rule_interval(g, h);
+  }
+}
+BENCHMARK_SIZES(bench_suboptimal_rule_interval);
+
+void bench_suboptimal_rule_pairs(State &state) {
+  InputData data = make_instance(state);
+  while (state.keep_running()) {
+    state.pause_timing();
+    Genome g(*data.g), h(*data.h);
+    state.resume_timing();
+    suboptimal_rule_pairs(g, h);
+  }
+}
+BENCHMARK_SIZES(bench_suboptimal_rule_pairs);
+
+/* Apply a sequence of random reversals, transpositions, insertions and
+ * deletions to g, as many as its genes, inserting labels of the alphabet.
+ * Every 1000 edits some positions are read, which needs the vectors. */
+static int64_t edit_genome(Genome &g, int alphabet, Rng &rng) {
+  int64_t edits = g.size(), read = 0;
+  for (int64_t t = 0; t < edits; ++t) {
+    int n = g.size();
+    int i = 2 + rng.below(n - 2);
+    int j = 2 + rng.below(n - 2);
+    if (i > j) swap(i, j);
+    /* Short genomes only grow. */
+    switch (n < 16 ? 2 : rng.below(4)) {
+    case 0:
+      g.reversal(i, j, rng.below(g.get_ir(i - 1) + 1),
+                 rng.below(g.get_ir(j) + 1));
+      break;
+    case 1: {
+      int k = j + 1 + rng.below(n - j);
+      if (i == j) break;
+      g.transposition(i, j, k, rng.below(g.get_ir(i - 1) + 1),
+                      rng.below(g.get_ir(j - 1) + 1),
+                      rng.below(g.get_ir(k - 1) + 1));
+      break;
+    }
+    case 2: {
+      vector<Gene> genes(1 + rng.below(8));
+      vector<IR> irs(genes.size());
+      for (size_t k = 0; k < genes.size(); ++k) {
+        genes[k] = (2 + rng.below(alphabet)) * (rng.below(2) ? 1 : -1);
+        irs[k] = rng.below(10);
+      }
+      g.insertion(i - 1, genes, irs);
+      break;
+    }
+    default:
+      j = min(i + 1 + int(rng.below(8)), n);
+      g.deletion(i, j, rng.below(g.get_ir(i - 1) + g.get_ir(j - 1) + 1));
+    }
+    if (t % 1000 == 999) {
+      read += g.occ(2 + rng.below(alphabet)) + g.pos(0).size();
+    }
+  }
+  return read;
+}
+
+static unique_ptr<Genome> make_edited_genome(State &state, bool tree) {
+  GeneratorParams params;
+  params.length = state.range(0);
+  params.alphabet = state.range(1);
+  params.ir_max = 9;
+  Rng rng(params.length, params.alphabet);
+  GeneratedInstance inst = generate_instance(params, rng);
+  unique_ptr<Genome> g(new Genome(inst.g.data(), inst.g.size(),
+                                  inst.g_irs.data(), inst.g_irs.size(), true));
+  if (tree) g->use_tree();
+  do_not_optimize(edit_genome(*g, params.alphabet, rng));
+  return g;
+}
+
+void bench_genome_edits(State &state) {
+  while (state.keep_running()) {
+    do_not_optimize(make_edited_genome(state, false)->size());
+  }
+}
+BENCHMARK_SIZES(bench_genome_edits);
+
+/* The same edits with Genome::use_tree, the result must be the genome of
+ * bench_genome_edits, which is checked after each iteration. */
+void bench_genome_edits_tree(State &state) {
+  unique_ptr<Genome> expected = make_edited_genome(state, false);
+  while (state.keep_running()) {
+    unique_ptr<Genome> g = make_edited_genome(state, true);
+    state.pause_timing();
+    bool same = (g->size() == expected->size() &&
+                 g->occ_max() == expected->occ_max());
+    for (size_t i = 1; same && i <= g->size(); ++i) {
+      same = ((*g)[i] == (*expected)[i] &&
+              g->check_alpha(i) == expected->check_alpha(i) &&
+              (i == g->size() || g->get_ir(i) == expected->get_ir(i)) &&
+              g->pos((*g)[i]) == expected->pos((*g)[i]));
+    }
+    if (!same) {
+      cerr << "bench_genome_edits_tree/" << state.range(0) << "/"
+           << state.range(1) << ": the tree and the vectors differ" << endl;
+      exit(EXIT_FAILURE);
+    }
+    state.resume_timing();
+  }
+}
+BENCHMARK_SIZES(bench_genome_edits_tree);
+
+/* Signed permutation with length / 4 random reversals applied to the
+ * identity, and the identity, as taken by the C sorting algorithms. */
+static void make_permutation(int n, vector<int> &g, vector<int> &h) {
+  Rng rng(n, 0);
+  h.resize(n);
+  iota(h.begin(), h.end(), 1);
+  g = h;
+  for (int t = 0; t < n / 4; ++t) {
+    int i = rng.below(n), j = rng.below(n);
+    if (i > j) swap(i, j);
+    reverse(g.begin() + i, g.begin() + j + 1);
+    for (int k = i; k <= j; ++k) g[k] = -g[k];
+  }
+}
+
+static void bench_sorting(State &state, perm *(*build)(int *, int *, int),
+                          int (*sort)(perm *)) {
+  vector<int> g, h;
+  make_permutation(state.range(0), g, h);
+  while (state.keep_running()) {
+    state.pause_timing();
+    perm *pi = build(g.data(), h.data(), g.size());
+    state.resume_timing();
+    do_not_optimize(sort(pi));
+    state.pause_timing();
+    free_sorting_perm(pi);
+    state.resume_timing();
+  }
+}
+
+void bench_bergeron(State &state) {
+  bench_sorting(state, build_reversal_perm, sort_bergeron);
+}
+BENCHMARK(bench_bergeron)->args({100})->args({1000})->args({10000});
+
+void bench_walter_bp(State &state) {
+  bench_sorting(state, build_transposition_reversal_perm, sort_walter_bp);
+}
+BENCHMARK(bench_walter_bp)->args({100})->args({1000})->args({10000});
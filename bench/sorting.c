@@ -0,0 +1,18 @@
+#include "sorting.h"
+#include "../distance_algorithms/perm/Bergeron/bergeron.h"
+#include "../distance_algorithms/perm/WalterBP/walter_bp.h"
+#include "../distance_algorithms/perm/misc/perm.h"
+
+perm *build_reversal_perm(int *g, int *h, int n) {
+  return build_and_rename_perm(g, h, n, PSign, Rev);
+}
+
+perm *build_transposition_reversal_perm(int *g, int *h, int n) {
+  return build_and_rename_perm(g, h, n, PSign, TransRev);
+}
+
+void free_sorting_perm(perm *pi) { clear_perm(pi); }
+
+int sort_bergeron(perm *pi) { return bergeron(pi); }
+
+int sort_walter_bp(perm *pi) { return walter_bp(pi); }
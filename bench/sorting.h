@@ -0,0 +1,26 @@
+#pragma once
+
+/* Typed wrappers of the C sorting algorithms for the benchmarks. The headers
+ * of the algorithms define bool, which C++ does not accept, so only
+ * sorting.c includes them and this header has no bool. */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct perm perm;
+
+/* Signed permutation g renamed by the target h (n genes each), for the
+ * reversal model (bergeron) or the transposition and reversal model
+ * (walter_bp). It must be freed with free_sorting_perm. */
+perm *build_reversal_perm(int *g, int *h, int n);
+perm *build_transposition_reversal_perm(int *g, int *h, int n);
+void free_sorting_perm(perm *pi);
+
+/* Number of operations found by each algorithm, pi is sorted by the call. */
+int sort_bergeron(perm *pi);
+int sort_walter_bp(perm *pi);
+
+#ifdef __cplusplus
+}
+#endif
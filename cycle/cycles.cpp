@@ -4,6 +4,7 @@
 #include <cassert>
 #include <cmath>
 #include <cstdlib>
+#include <limits>
 #include <numeric>
 #include <queue>
 #include <sstream>
@@ -11,88 +12,97 @@
 #include "../misc/genome.hpp"
 #include "../misc/io.hpp"
 
-CycleGraph::CycleGraph(const Genome &origin, const Genome &target)
-    : vertices(2 * (origin.size() + target.size()) - 4),
-      cycles(),
-      indel_count() {
+AdjacencyGraphTopology::AdjacencyGraphTopology(const Genome &origin,
+                                               const Genome &target)
+    : black(2 * (origin.size() + target.size()) - 4, NO_EDGE),
+      indel(black.size(), NO_EDGE),
+      weigth(black.size(), 0),
+      gene_val(black.size(), -1),
+      indel_update(black.size(), 0),
+      sign_positive(black.size(), false) {
   int a = max(origin.size(), target.size());
   int b = max(origin.get_op_max(), target.get_op_max());
   op_max = max(a, b) + 1;
+  indel_count.assign(op_max, 0);
   fhs = 2 * origin.size() -
         2;  // number of vertices correspondent to genes of the origin genome
 
   /* Using gene values to label the vertices, also indicate how to update indels
    * of each vertice */
-  vertices[0].gene_val = abs(origin[1]);
-  vertices[0].indel_update = -1;
+  caps[0] = 0;
+  caps[1] = fhs - 1;
+  caps[2] = fhs;
+  caps[3] = size() - 1;
+  gene_val[0] = abs(origin[1]);
+  indel_update[0] = -1;
   for (size_t i = 2; i < origin.size(); ++i) {
-    vertices[2 * i - 3].gene_val = abs(origin[i]);
-    vertices[2 * i - 3].indel_update = -1;
-    vertices[2 * i - 2].gene_val = abs(origin[i]);
-    vertices[2 * i - 2].indel_update = -1;
-  }
-  vertices[fhs - 1].gene_val = abs(origin[origin.size()]);
-  vertices[fhs - 1].indel_update = -1;
-  vertices[fhs].gene_val = abs(target[1]);
-  vertices[fhs].indel_update = 1;
+    gene_val[2 * i - 3] = abs(origin[i]);
+    indel_update[2 * i - 3] = -1;
+    gene_val[2 * i - 2] = abs(origin[i]);
+    indel_update[2 * i - 2] = -1;
+  }
+  gene_val[fhs - 1] = abs(origin[origin.size()]);
+  indel_update[fhs - 1] = -1;
+  gene_val[fhs] = abs(target[1]);
+  indel_update[fhs] = 1;
   for (size_t i = 2; i < target.size(); ++i) {
-    vertices[fhs + 2 * i - 3].gene_val = abs(target[i]);
-    vertices[fhs + 2 * i - 3].indel_update = 1;
-    vertices[fhs + 2 * i - 2].gene_val = abs(target[i]);
-    vertices[fhs + 2 * i - 2].indel_update = 1;
+    gene_val[fhs + 2 * i - 3] = abs(target[i]);
+    indel_update[fhs + 2 * i - 3] = 1;
+    gene_val[fhs + 2 * i - 2] = abs(target[i]);
+    indel_update[fhs + 2 * i - 2] = 1;
   }
-  vertices[vertices.size() - 1].gene_val = abs(target[target.size()]);
-  vertices[vertices.size() - 1].indel_update = 1;
+  gene_val[size() - 1] = abs(target[target.size()]);
+  indel_update[size() - 1] = 1;
 
   /* Black Edges */
-  for (size_t i = 0; i < vertices.size(); ++i) {
+  for (size_t i = 0; i < size(); ++i) {
     if (i % 2 == 0) {
-      vertices[i].black = i + 1;
+      black[i] = i + 1;
     } else {
-      vertices[i].black = i - 1;
+      black[i] = i - 1;
     }
   }
 
   /* Indel Edges */
   for (size_t i = 2; i < origin.size(); ++i) {
     indel_count[abs(origin[i])]++;
-    vertices[2 * i - 3].indel = 2 * i - 2;
-    vertices[2 * i - 2].indel = 2 * i - 3;
+    indel[2 * i - 3] = 2 * i - 2;
+    indel[2 * i - 2] = 2 * i - 3;
   }
 
   for (size_t i = 2; i < target.size(); ++i) {
     indel_count[abs(target[i])]--;
-    vertices[fhs + 2 * i - 3].indel = fhs + 2 * i - 2;
-    vertices[fhs + 2 * i - 2].indel = fhs + 2 * i - 3;
+    indel[fhs + 2 * i - 3] = fhs + 2 * i - 2;
+    indel[fhs + 2 * i - 2] = fhs + 2 * i - 3;
   }
 
   /* Weigths */
-  vertices[0].weigth = origin.get_ir(1);
+  weigth[0] = origin.get_ir(1);
   for (size_t i = 1; i < origin.size() - 1; ++i) {
-    vertices[2 * i - 1].weigth = origin.get_ir(i);
-    vertices[2 * i].weigth = origin.get_ir(i + 1);
+    weigth[2 * i - 1] = origin.get_ir(i);
+    weigth[2 * i] = origin.get_ir(i + 1);
   }
-  vertices[fhs - 1].weigth = origin.get_ir(origin.size() - 1);
-  vertices[fhs].weigth = target.get_ir(1);
+  weigth[fhs - 1] = origin.get_ir(origin.size() - 1);
+  weigth[fhs] = target.get_ir(1);
   for (size_t i = 1; i < target.size() - 1; ++i) {
-    vertices[fhs + 2 * i - 1].weigth = target.get_ir(i);
-    vertices[fhs + 2 * i].weigth = target.get_ir(i + 1);
+    weigth[fhs + 2 * i - 1] = target.get_ir(i);
+    weigth[fhs + 2 * i] = target.get_ir(i + 1);
   }
-  vertices[vertices.size() - 1].weigth = target.get_ir(target.size() - 1);
+  weigth[size() - 1] = target.get_ir(target.size() - 1);
 
   /* Signed */
-  vertices[0].sign_positive = true;
+  sign_positive[0] = true;
   for (size_t i = 1; i < origin.size() - 1; ++i) {
-    vertices[2 * i - 1].sign_positive = origin[i + 1] >= 0;
-    vertices[2 * i].sign_positive = origin[i + 1] >= 0;
+    sign_positive[2 * i - 1] = origin[i + 1] >= 0;
+    sign_positive[2 * i] = origin[i + 1] >= 0;
   }
-  vertices[fhs - 1].sign_positive = true;
-  vertices[fhs].sign_positive = true;
+  sign_positive[fhs - 1] = true;
+  sign_positive[fhs] = true;
   for (size_t i = 1; i < target.size() - 1; ++i) {
-    vertices[fhs + 2 * i - 1].sign_positive = target[i + 1] >= 0;
-    vertices[fhs + 2 * i].sign_positive = target[i + 1] >= 0;
+    sign_positive[fhs + 2 * i - 1] = target[i + 1] >= 0;
+    sign_positive[fhs + 2 * i] = target[i + 1] >= 0;
   }
-  vertices[vertices.size() - 1].sign_positive = true;
+  sign_positive[size() - 1] = true;
 
   /* Gray Edges */
   assert(origin[1] == target[1] &&
@@ -102,166 +112,431 @@ CycleGraph::CycleGraph(const Genome &origin, const Genome &target)
          target.pos(target[1]).size() == 1 &&
          target.pos(target[target.size()]).size() == 1);
 
-  vertices[0].grays.push_back(fhs);
-  vertices[fhs].grays.push_back(0);
-  vertices[fhs - 1].grays.push_back(vertices.size() - 1);
-  vertices[vertices.size() - 1].grays.push_back(fhs - 1);
+  vector<pair<Vtx_id, Vtx_id>> edges;
+  edges.push_back(make_pair(0, fhs));
+  edges.push_back(make_pair(fhs, 0));
+  edges.push_back(make_pair(fhs - 1, size() - 1));
+  edges.push_back(make_pair(size() - 1, fhs - 1));
   for (size_t i = 2; i < origin.size(); ++i) {
     for (auto j : target.pos(abs(origin[i]))) {
       if (origin[i] == target[j]) {
-        vertices[2 * i - 3].grays.push_back(fhs + 2 * j - 3);
-        vertices[2 * i - 2].grays.push_back(fhs + 2 * j - 2);
-        vertices[fhs + 2 * j - 3].grays.push_back(2 * i - 3);
-        vertices[fhs + 2 * j - 2].grays.push_back(2 * i - 2);
+        edges.push_back(make_pair(2 * i - 3, fhs + 2 * j - 3));
+        edges.push_back(make_pair(2 * i - 2, fhs + 2 * j - 2));
+        edges.push_back(make_pair(fhs + 2 * j - 3, 2 * i - 3));
+        edges.push_back(make_pair(fhs + 2 * j - 2, 2 * i - 2));
       } else {
-        vertices[2 * i - 2].grays.push_back(fhs + 2 * j - 3);
-        vertices[2 * i - 3].grays.push_back(fhs + 2 * j - 2);
-        vertices[fhs + 2 * j - 2].grays.push_back(2 * i - 3);
-        vertices[fhs + 2 * j - 3].grays.push_back(2 * i - 2);
+        edges.push_back(make_pair(2 * i - 2, fhs + 2 * j - 3));
+        edges.push_back(make_pair(2 * i - 3, fhs + 2 * j - 2));
+        edges.push_back(make_pair(fhs + 2 * j - 2, 2 * i - 3));
+        edges.push_back(make_pair(fhs + 2 * j - 3, 2 * i - 2));
       }
     }
   }
+  grays = GrayEdges(size(), edges);
+}
+
+void AdjacencyGraphTopology::index_labels() {
+  for (auto &genes : label_genes) genes.assign(op_max, vector<Vtx_id>());
+  for (Vtx_id v = 0; v < Vtx_id(size()); ++v) {
+    if (indel[v] != NO_EDGE && v < indel[v]) {
+      label_genes[indel_update[v] < 0 ? 0 : 1][gene_val[v]].push_back(v);
+    }
+  }
+}
+
+Vtx_id AdjacencyGraphTopology::add_gene(Gene a, bool in_origin) {
+  int side = in_origin ? 0 : 1;
+  in_genome_order = false;
+
+  Vtx_id l = size(), r = l + 1;
+  for (int k = 0; k < 2; ++k) {
+    black.push_back(NO_EDGE);
+    indel.push_back(k == 0 ? r : l);
+    weigth.push_back(0);
+    gene_val.push_back(abs(a));
+    indel_update.push_back(in_origin ? -1 : 1);
+    sign_positive.push_back(a >= 0);
+    grays.add_vertex();
+  }
+  indel_count[abs(a)] += in_origin ? 1 : -1;
+
+  /* Same extremities if the signs are equal, like in the constructor. */
+  for (Vtx_id l2 : label_genes[1 - side][abs(a)]) {
+    Vtx_id r2 = indel[l2];
+    if (sign_positive[l2] != (a >= 0)) swap(l2, r2);
+    grays.add_edge(l, l2);
+    grays.add_edge(l2, l);
+    grays.add_edge(r, r2);
+    grays.add_edge(r2, r);
+  }
+  label_genes[side][abs(a)].push_back(l);
+  return l;
+}
+
+Decomposition::Decomposition(const AdjacencyGraphTopology &topo) {
+  reset(topo);
+}
+
+void Decomposition::reset(const AdjacencyGraphTopology &topo) {
+  fix_gray.assign(topo.size(), NO_EDGE);
+  flags.assign(topo.size(), 0);
+  cycles.clear();
+  indel_count = topo.indel_count;
+  balanced_cycles = 0;
+  indel_potation = 0;
+
+  /* The gray edges of the first and last genes are always fixed. */
+  for (Vtx_id v : topo.caps) {
+    fix_gray[v] = topo.grays.adj[topo.grays.first[v]];
+  }
+}
+
+/* The topology is not created const, so insert_runs can change it when the
+ * graph is its only owner (see own_topology). */
+CycleGraph::CycleGraph(const Genome &origin, const Genome &target)
+    : topo(make_shared<AdjacencyGraphTopology>(origin, target)),
+      dec(*topo) {}
+
+CycleGraph::CycleGraph(shared_ptr<const AdjacencyGraphTopology> topo)
+    : topo(topo), dec(*topo) {}
 
-  vertices[0].fix_gray = vertices[0].grays[0];
-  vertices[fhs - 1].fix_gray = vertices[fhs - 1].grays[0];
-  vertices[fhs].fix_gray = vertices[fhs].grays[0];
-  vertices[vertices.size() - 1].fix_gray =
-      vertices[vertices.size() - 1].grays[0];
+GrayEdges::GrayEdges(size_t n_vertices,
+                     const vector<pair<Vtx_id, Vtx_id>> &edges)
+    : first(n_vertices, 0), last(n_vertices, 0), adj(edges.size()) {
+  /* Counting sort by the first vertex, keeping the order of the edges. */
+  for (auto &e : edges) {
+    last[e.first]++;
+  }
+  for (size_t v = 1; v < n_vertices; ++v) {
+    first[v] = first[v - 1] + last[v - 1];
+  }
+  for (size_t v = 0; v < n_vertices; ++v) {
+    last[v] = first[v];
+  }
+  for (auto &e : edges) {
+    adj[last[e.first]++] = e.second;
+  }
+}
+
+void GrayEdges::add_edge(Vtx_id v, Vtx_id u) {
+  if (last[v] != int(adj.size())) {
+    int start = adj.size();
+    for (int k = first[v]; k < last[v]; ++k) {
+      Vtx_id w = adj[k];
+      adj.push_back(w);
+    }
+    first[v] = start;
+    last[v] = adj.size();
+  }
+  adj.push_back(u);
+  last[v]++;
+}
+
+AdjacencyGraphTopology &CycleGraph::own_topology() {
+  if (topo.use_count() > 1) {
+    topo = make_shared<AdjacencyGraphTopology>(*topo);
+  }
+  return const_cast<AdjacencyGraphTopology &>(*topo);
 }
 
 /* Decompose the remaning graph using bfs */
-void CycleGraph::decompose_with_bfs(bool is_random) {
+void CycleGraph::decompose_with_bfs(bool is_random, Rng &rng) {
   vector<Vtx_id> idxs(size());
   iota(idxs.begin(), idxs.end(), 0);
   if (is_random) {
-    random_shuffle(idxs.begin(), idxs.end());
+    shuffle(idxs.begin(), idxs.end(), rng);
   }
   for (Vtx_id i : idxs) {
-    bfs(i, is_random);
+    bfs(i, is_random, rng);
   }
 }
 
-void CycleGraph::bfs(Vtx_id start, bool is_random) {
-  unique_ptr<QEntry> entry;
-  vector<unique_ptr<QEntry>> q1;
-  vector<unique_ptr<QEntry>> q2;
-  set<Vtx_id> vizited_in_level;
+vector<Vtx_id> CycleGraph::insert_runs(const vector<Run> &runs, Rng &rng) {
+  /* Indexes built once, in O(n). */
+  AdjacencyGraphTopology &t = own_topology();
+  if (t.label_genes[0].empty()) t.index_labels();
+  if (cycle_at.empty()) {
+    cycle_at.assign(size(), -1);
+    for (size_t k = 0; k < dec.cycles.size(); ++k) {
+      cycle_at[dec.cycles[k].second] = k;
+    }
+  }
+
+  /* Remove the cycles before the graph changes. The indel edges of the
+   * inserted labels can no longer be used, since their balance changes. */
+  vector<Vtx_id> freed;
+  for (const Run &run : runs) {
+    drop_cycle(run.adjacency, freed);
+    for (Gene a : run.genes_to_add) {
+      for (auto &genes : t.label_genes) {
+        for (Vtx_id l : genes[abs(a)]) {
+          if (is_indel(l)) drop_cycle(l, freed);
+        }
+      }
+    }
+  }
+
+  for (const Run &run : runs) {
+    bool in_origin = (run.genome == 'G');
+    /* Black edge (x, y), from the gene before the insertion to the gene
+     * after it, its intergenic region goes after the inserted genes. */
+    Vtx_id x = run.adjacency, y = t.black[x];
+    if (left_end(x)) swap(x, y);
+    IR ir = t.weigth[x];
+    Vtx_id prev = x;
+    for (Gene a : run.genes_to_add) {
+      Vtx_id l = t.add_gene(a, in_origin);
+      for (int k = 0; k < 2; ++k) {
+        dec.fix_gray.push_back(NO_EDGE);
+        dec.flags.push_back(0);
+        cycle_at.push_back(-1);
+        freed.push_back(l + k);
+      }
+      dec.indel_count[abs(a)] += in_origin ? 1 : -1;
+      for (Vtx_id l2 : t.label_genes[in_origin ? 1 : 0][abs(a)]) {
+        unfix_gray(l2);
+        unfix_gray(t.indel[l2]);
+      }
+      t.black[prev] = l;
+      t.black[l] = prev;
+      t.weigth[prev] = t.weigth[l] = 0;
+      prev = t.indel[l];
+    }
+    t.black[prev] = y;
+    t.black[y] = prev;
+    t.weigth[prev] = t.weigth[y] = ir;
+  }
+
+  size_t first_new = dec.cycles.size();
+  shuffle(freed.begin(), freed.end(), rng);
+  for (Vtx_id v : freed) {
+    bfs(v, true, rng);
+  }
+  vector<Vtx_id> added;
+  for (size_t k = first_new; k < dec.cycles.size(); ++k) {
+    added.push_back(dec.cycles[k].second);
+  }
+  return added;
+}
+
+void CycleGraph::drop_cycle(Vtx_id v, vector<Vtx_id> &freed) {
+  if (!in_cycle(v)) return;
+  vector<Vtx_id> cycle = get_cycle(v);
+  Vtx_id start = *find_if(cycle.begin(), cycle.end(),
+                          [this](Vtx_id u) { return cycle_at[u] != -1; });
+  release_cycle(start);
+  freed.insert(freed.end(), cycle.begin(), cycle.end());
+
+  size_t k = cycle_at[start];
+  dec.cycles[k] = dec.cycles.back();
+  dec.cycles.pop_back();
+  if (k < dec.cycles.size()) cycle_at[dec.cycles[k].second] = k;
+  cycle_at[start] = -1;
+}
+
+void CycleGraph::unfix_gray(Vtx_id v) {
+  Vtx_id u = dec.fix_gray[v];
+  if (u == NO_EDGE || in_cycle(v)) return;
+  Vtx_id v2 = topo->indel[v], u2 = topo->indel[u];
+  if (!in_cycle(u) && !in_cycle(v2) && !in_cycle(u2)) {
+    dec.fix_gray[v] = dec.fix_gray[u] = NO_EDGE;
+    dec.fix_gray[v2] = dec.fix_gray[u2] = NO_EDGE;
+  }
+}
+
+void CycleGraph::genome_order(bool origin, vector<Gene> &genes,
+                              vector<IR> &irs) const {
+  genes.clear();
+  irs.clear();
+  Vtx_id v = topo->caps[origin ? 0 : 2];
+  Vtx_id last = topo->caps[origin ? 1 : 3];
+  genes.push_back(topo->gene_val[v]);
+  while (v != last) {
+    irs.push_back(topo->weigth[v]);
+    Vtx_id u = topo->black[v];
+    genes.push_back(sign_positive(u) ? topo->gene_val[u] : -topo->gene_val[u]);
+    v = (u == last) ? u : topo->indel[u];
+  }
+}
+
+void BfsScratch::reset(size_t n_vertices, size_t n_genes) {
+  nodes.clear();
+  /* The stamps of new entries are never current, so the graph can grow
+   * without clearing the arrays. */
+  if (vizited.size() < n_vertices) {
+    vizited.resize(n_vertices, 0);
+    fixed_at.resize(n_vertices, 0);
+    fixed.resize(n_vertices, NO_EDGE);
+    in_level.resize(n_vertices, 0);
+  }
+  if (indel_at.size() < n_genes) {
+    indel_at.resize(n_genes, 0);
+    indel_delta.resize(n_genes, 0);
+  }
+  /* A search has at most one level per vertex. */
+  if (level > numeric_limits<unsigned>::max() - n_vertices - 1) {
+    vizited.assign(n_vertices, 0);
+    fixed_at.assign(n_vertices, 0);
+    fixed.assign(n_vertices, NO_EDGE);
+    in_level.assign(n_vertices, 0);
+    indel_at.assign(n_genes, 0);
+    indel_delta.assign(n_genes, 0);
+    epoch = 0;
+    level = 0;
+  }
+}
+
+void BfsScratch::next_epoch() {
+  if (epoch == numeric_limits<unsigned>::max()) {
+    fill(vizited.begin(), vizited.end(), 0);
+    fill(fixed_at.begin(), fixed_at.end(), 0);
+    fill(indel_at.begin(), indel_at.end(), 0);
+    epoch = 0;
+  }
+  epoch++;
+}
+
+void CycleGraph::load_path(int node) {
+  scratch.next_epoch();
+  for (int i = node; scratch.nodes[i].parent != -1;
+       i = scratch.nodes[i].parent) {
+    const BfsNode &n = scratch.nodes[i];
+    scratch.vizited[n.v] = scratch.epoch;
+    scratch.vizited[n.u] = scratch.epoch;
+    /* Nodes closer to the end of the path have precedence. */
+    Vtx_id ends[4] = {n.v, n.u, n.alter_v, n.alter_u};
+    for (int k = 0; k < 4; k += 2) {
+      if (ends[k] == NO_EDGE) continue;
+      for (int l = 0; l < 2; ++l) {
+        Vtx_id a = ends[k + l], b = ends[k + 1 - l];
+        if (scratch.fixed_at[a] != scratch.epoch) {
+          scratch.fixed_at[a] = scratch.epoch;
+          scratch.fixed[a] = b;
+        }
+      }
+    }
+    if (n.indel) {
+      Gene a = topo->gene_val[n.u];
+      if (scratch.indel_at[a] != scratch.epoch) {
+        scratch.indel_at[a] = scratch.epoch;
+        scratch.indel_delta[a] = 0;
+      }
+      scratch.indel_delta[a] += topo->indel_update[n.u];
+    }
+  }
+}
+
+void CycleGraph::bfs(Vtx_id start, bool is_random, Rng &rng) {
+  vector<int> q1;
+  vector<int> q2;
+  vector<Vtx_id> neigs;
+  vector<Vtx_id> notDone;
+  int entry;
   Vtx_id headtailcorresp_v, headtailcorresp_u;
   size_t pos = 0;
 
-  if (vertices[start].in_cycle) return;
+  if (in_cycle(start)) return;
 
-  q1.push_back(unique_ptr<QEntry>(new QEntry(start, this->indel_count)));
-  vizited_in_level.insert(start);
+  scratch.reset(size(), dec.indel_count.size());
+  vector<BfsNode> &nodes = scratch.nodes;
+  nodes.push_back(BfsNode(start));
+  q1.push_back(0);
+  scratch.level++;
+  scratch.in_level[start] = scratch.level;
 
   do {
-    entry = move(q1[pos]);
+    entry = q1[pos];
     pos++;
+    load_path(entry);
 
-    Vtx_id v = vertices[entry->vtx].black;
+    Vtx_id v = topo->black[nodes[entry].vtx];
 
     /* Follow indel edge */
-    if (vertices[v].fix_gray == NO_EDGE &&
-        !vertices[vertices[v].indel].in_cycle) {
-      Vtx_id u = vertices[v].indel;
-      if (entry->indel_count[vertices[u].gene_val] * vertices[u].indel_update <
+    if (dec.fix_gray[v] == NO_EDGE &&
+        !in_cycle(topo->indel[v])) {
+      Vtx_id u = topo->indel[v];
+      if (path_indel_count(topo->gene_val[u]) * topo->indel_update[u] <
               0 &&
-          vizited_in_level.find(u) == vizited_in_level.end() &&
-          entry->vizited.find(u) == entry->vizited.end()) {
-        q2.push_back(unique_ptr<QEntry>(new QEntry(
-            v, u, entry->fixed, entry->vizited, entry->indel_count)));
-        q2.back()->indel_count[vertices[u].gene_val] +=
-            vertices[u].indel_update;
-        vizited_in_level.insert(u);
+          scratch.in_level[u] != scratch.level && !path_vizited(u)) {
+        nodes.push_back(BfsNode(entry, v, u, NO_EDGE, NO_EDGE, true));
+        q2.push_back(nodes.size() - 1);
+        scratch.in_level[u] = scratch.level;
       }
     }
 
     /* Follow each gray edge */
-    vector<Vtx_id> neigs;
-    if (vertices[v].fix_gray != NO_EDGE) {
-      neigs.push_back(vertices[v].fix_gray);
-    } else if (!vertices[v].is_indel) {
-      auto vu = entry->fixed.find(v);
-      if (vu != entry->fixed.end()) {
-        neigs.push_back(vu->second);
+    neigs.clear();
+    if (dec.fix_gray[v] != NO_EDGE) {
+      neigs.push_back(dec.fix_gray[v]);
+    } else if (!is_indel(v)) {
+      Vtx_id vu = path_fixed(v);
+      if (vu != NO_EDGE) {
+        neigs.push_back(vu);
       } else {
-        for (auto u : vertices[v].grays) {
-          if (entry->fixed.find(u) == entry->fixed.end() &&
-              vertices[u].fix_gray == NO_EDGE) {
+        for (auto u : grays(v)) {
+          if (path_fixed(u) == NO_EDGE && dec.fix_gray[u] == NO_EDGE) {
             neigs.push_back(u);
           }
         }
       }
     }
 
-    vector<Vtx_id> notDone;
+    notDone.clear();
     for (Vtx_id u : neigs) {
-      if (!vertices[u].in_cycle &&
-          vizited_in_level.find(u) == vizited_in_level.end() &&
-          entry->vizited.find(u) == entry->vizited.end()) {
+      if (!in_cycle(u) && scratch.in_level[u] != scratch.level &&
+          !path_vizited(u)) {
         notDone.push_back(u);
       }
     }
 
-    if (vertices[v].fix_gray == NO_EDGE) {
+    if (dec.fix_gray[v] == NO_EDGE) {
       for (Vtx_id u : notDone) {
-        if ((v % fhs) % 2 == 1) {
-          headtailcorresp_v = v + 1;
-        } else {
-          headtailcorresp_v = v - 1;
-        }
-        if ((u % fhs) % 2 == 1) {
-          headtailcorresp_u = u + 1;
-        } else {
-          headtailcorresp_u = u - 1;
-        }
-        q2.push_back(unique_ptr<QEntry>(
-            new QEntry(v, u, headtailcorresp_v, headtailcorresp_u, entry->fixed,
-                       entry->vizited, entry->indel_count)));
-        vizited_in_level.insert(u);
+        headtailcorresp_v = topo->indel[v];
+        headtailcorresp_u = topo->indel[u];
+        nodes.push_back(BfsNode(entry, v, u, headtailcorresp_v,
+                                headtailcorresp_u, false));
+        q2.push_back(nodes.size() - 1);
+        scratch.in_level[u] = scratch.level;
       }
     } else {
       for (Vtx_id u : notDone) {
-        q2.push_back(unique_ptr<QEntry>(new QEntry(
-            v, u, entry->fixed, entry->vizited, entry->indel_count)));
-        vizited_in_level.insert(u);
+        nodes.push_back(BfsNode(entry, v, u, NO_EDGE, NO_EDGE, false));
+        q2.push_back(nodes.size() - 1);
+        scratch.in_level[u] = scratch.level;
       }
     }
 
     if (pos == q1.size()) {
-      q1.clear();
-      for (unique_ptr<QEntry> &e : q2) {
-        q1.push_back(move(e));
-      }
+      swap(q1, q2);
       if (is_random) {
-        random_shuffle(q1.begin(), q1.end());
+        shuffle(q1.begin(), q1.end(), rng);
       }
       q2.clear();
-      vizited_in_level.clear();
+      scratch.level++;
       pos = 0;
     }
-  } while (q1[pos]->vtx != start);
+  } while (nodes[q1[pos]].vtx != start);
 
   /* Find balanced cycle in level if it exists */
   vector<Vtx_id> cycle;
   bool ok = false;
   for (; pos < q1.size(); pos++) {
-    if (q1[pos]->vtx == start) {
-      entry = move(q1[pos]);
+    if (nodes[q1[pos]].vtx == start) {
+      load_path(q1[pos]);
       cycle.clear();
       Vtx_id u, v;
-      int weigth = 0;
+      int w = 0;
       v = start;
       do {
-        u = vertices[v].black;
+        u = topo->black[v];
         cycle.push_back(v);
         cycle.push_back(u);
-        v = entry->fixed[u];
-        if (v != vertices[u].indel) {
-          weigth += vertices[v].weigth;
+        v = path_fixed(u);
+        if (v != topo->indel[u]) {
+          w += topo->weigth[v];
         }
       } while (v != start);
-      if (weigth == 0) {
+      if (w == 0) {
         ok = true;
         add_cycle(cycle);
         break;
@@ -277,20 +552,20 @@ string CycleGraph::show_cycles() const {
   ostringstream ss;
 
   ss << '[';
-  for (size_t i = 0; i < cycles.size(); ++i) {
-    Vtx_id v = cycles[i].second;
+  for (size_t i = 0; i < dec.cycles.size(); ++i) {
+    Vtx_id v = dec.cycles[i].second;
     ss << '[' << v;
-    v = vertices[v].black;
+    v = topo->black[v];
     ss << "," << v;
-    v = vertices[v].is_indel ? vertices[v].indel : vertices[v].fix_gray;
-    while (v != cycles[i].second) {
+    v = is_indel(v) ? topo->indel[v] : dec.fix_gray[v];
+    while (v != dec.cycles[i].second) {
       ss << "," << v;
-      v = vertices[v].black;
+      v = topo->black[v];
       ss << "," << v;
-      v = vertices[v].is_indel ? vertices[v].indel : vertices[v].fix_gray;
+      v = is_indel(v) ? topo->indel[v] : dec.fix_gray[v];
     }
     ss << ']';
-    if (i != cycles.size() - 1) ss << ',';
+    if (i != dec.cycles.size() - 1) ss << ',';
   }
   ss << ']';
 
@@ -328,9 +603,10 @@ void CycleGraph::read_cycles(string str) {
 }
 
 PermsIrs CycleGraph::get_perms() {
+  assert(topo->in_genome_order);
   PermsIrs perms_irs;
-  perms_irs.s_n = (fhs + 2) / 2;
-  perms_irs.p_n = (vertices.size() - fhs + 2) / 2;
+  perms_irs.s_n = (topo->fhs + 2) / 2;
+  perms_irs.p_n = (size() - topo->fhs + 2) / 2;
   perms_irs.s = (int *)malloc(perms_irs.s_n * sizeof(int));
   perms_irs.s_ir = (int *)malloc((perms_irs.s_n - 1) * sizeof(int));
   perms_irs.p = (int *)malloc(perms_irs.p_n * sizeof(int));
@@ -341,44 +617,44 @@ PermsIrs CycleGraph::get_perms() {
     perms_irs.p[i] = i + 1;
   }
 
-  for (size_t i = 0; i < cycles.size(); ++i) {
-    Vtx_id v = cycles[i].second;
-    Vtx_id u = vertices[v].black;
+  for (size_t i = 0; i < dec.cycles.size(); ++i) {
+    Vtx_id v = dec.cycles[i].second;
+    Vtx_id u = topo->black[v];
 
-    while (vertices[u].is_indel) {
-      if (u < fhs) {
+    while (is_indel(u)) {
+      if (u < topo->fhs) {
         perms_irs.s[(u + 1) / 2] = 0;
       } else {
-        perms_irs.p[(u - fhs + 1) / 2] = 0;
+        perms_irs.p[(u - topo->fhs + 1) / 2] = 0;
       }
-      u = vertices[vertices[u].indel].black;
+      u = topo->black[topo->indel[u]];
     }
-    v = vertices[u].fix_gray;
+    v = dec.fix_gray[u];
 
     Vtx_id a = min(v, u);
     Vtx_id b = max(v, u);
-    if (vertices[a].sign_positive == vertices[b].sign_positive) {
-      perms_irs.s[(a + 1) / 2] = perms_irs.p[(b - fhs + 1) / 2];
+    if (sign_positive(a) == sign_positive(b)) {
+      perms_irs.s[(a + 1) / 2] = perms_irs.p[(b - topo->fhs + 1) / 2];
     } else {
-      perms_irs.s[(a + 1) / 2] = -perms_irs.p[(b - fhs + 1) / 2];
+      perms_irs.s[(a + 1) / 2] = -perms_irs.p[(b - topo->fhs + 1) / 2];
     }
-    while (v != cycles[i].second) {
-      u = vertices[v].black;
-      if (vertices[u].is_indel) {
-        if (u < fhs) {
+    while (v != dec.cycles[i].second) {
+      u = topo->black[v];
+      if (is_indel(u)) {
+        if (u < topo->fhs) {
           perms_irs.s[(u + 1) / 2] = 0;
         } else {
-          perms_irs.p[(u - fhs + 1) / 2] = 0;
+          perms_irs.p[(u - topo->fhs + 1) / 2] = 0;
         }
-        v = vertices[u].indel;
+        v = topo->indel[u];
       } else {
-        v = vertices[u].fix_gray;
+        v = dec.fix_gray[u];
         Vtx_id a = min(v, u);
         Vtx_id b = max(v, u);
-        if (vertices[a].sign_positive == vertices[b].sign_positive) {
-          perms_irs.s[(a + 1) / 2] = perms_irs.p[(b - fhs + 1) / 2];
+        if (sign_positive(a) == sign_positive(b)) {
+          perms_irs.s[(a + 1) / 2] = perms_irs.p[(b - topo->fhs + 1) / 2];
         } else {
-          perms_irs.s[(a + 1) / 2] = -perms_irs.p[(b - fhs + 1) / 2];
+          perms_irs.s[(a + 1) / 2] = -perms_irs.p[(b - topo->fhs + 1) / 2];
         }
       }
     }
@@ -388,13 +664,13 @@ PermsIrs CycleGraph::get_perms() {
   size_t i = 1, j = 1, k = 1, l = 1;
   for (; i < perms_irs.s_n || j < perms_irs.p_n;) {
     if (i < perms_irs.s_n) {
-      perms_irs.s_ir[k - 1] = vertices[2 * i - 1].weigth;
+      perms_irs.s_ir[k - 1] = topo->weigth[2 * i - 1];
       perms_irs.s[k - 1] = perms_irs.s[i - 1];
       k++;
       i++;
     }
     if (j < perms_irs.p_n) {
-      perms_irs.p_ir[l - 1] = vertices[fhs + 2 * j - 1].weigth;
+      perms_irs.p_ir[l - 1] = topo->weigth[topo->fhs + 2 * j - 1];
       perms_irs.p[l - 1] = perms_irs.p[j - 1];
       l++;
       j++;
@@ -411,10 +687,11 @@ PermsIrs CycleGraph::get_perms() {
   perms_irs.s_n = k;
   perms_irs.p_n = l;
 
+  Gene label = topo->op_max;
   for (j = 0; j < perms_irs.p_n; ++j) {
     if (perms_irs.p[j] == 0) {
-      perms_irs.p[j] = op_max;
-      op_max++;
+      perms_irs.p[j] = label;
+      label++;
     }
   }
 
@@ -422,24 +699,24 @@ PermsIrs CycleGraph::get_perms() {
 }
 
 void CycleGraph::serialize(ostream &os) const {
-  for (size_t i = 0; i < vertices.size(); ++i) {
-    os << i << "(" << vertices[i].gene_val << "," << vertices[i].black << ","
-       << vertices[i].weigth << "," << vertices[i].in_cycle << ","
-       << vertices[i].sign_positive << "|";
+  for (size_t i = 0; i < size(); ++i) {
+    os << i << "(" << topo->gene_val[i] << "," << topo->black[i] << ","
+       << topo->weigth[i] << "," << in_cycle(i) << ","
+       << sign_positive(i) << "|";
     os << "[";
-    if (vertices[i].is_indel) {
-      os << "!" << vertices[i].indel;
-    } else if (vertices[i].fix_gray == NO_EDGE) {
-      for (auto gray : vertices[i].grays) {
+    if (is_indel(i)) {
+      os << "!" << topo->indel[i];
+    } else if (dec.fix_gray[i] == NO_EDGE) {
+      for (auto gray : grays(i)) {
         os << gray << ",";
       }
-      os << "!" << vertices[i].indel;
+      os << "!" << topo->indel[i];
     } else {
-      os << "*" << vertices[i].fix_gray;
+      os << "*" << dec.fix_gray[i];
     }
     os << "])"
        << " ";
-    if (int(i) == fhs - 1) os << endl;
+    if (int(i) == topo->fhs - 1) os << endl;
   }
 }
 
@@ -458,65 +735,66 @@ ostream &operator<<(ostream &os, const Run &r) {
 }
 
 void CycleGraph::rem_cycle(pair<size_t, Vtx_id> c) {
+  release_cycle(c.second);
+  auto it = dec.cycles.erase(find(dec.cycles.begin(), dec.cycles.end(), c));
+  if (!cycle_at.empty()) {
+    cycle_at[c.second] = -1;
+    for (; it != dec.cycles.end(); ++it) {
+      cycle_at[it->second] = it - dec.cycles.begin();
+    }
+  }
+}
+
+void CycleGraph::release_cycle(Vtx_id i) {
   Vtx_id headtailcorresp_v, headtailcorresp_u;
-  Vtx_id i = c.second;
 
   if (cycle_weight(i) == 0) {
-    balanced_cycles--;
+    dec.balanced_cycles--;
   }
-  indel_potation -= cycle_potation(i);
+  dec.indel_potation -= cycle_potation(i);
   vector<Vtx_id> cycle = get_cycle(i);
 
   assert(cycle.size() % 2 == 0);
   for (size_t i = 0; i < cycle.size(); ++i) {
     Vtx_id v = cycle[i];
-    assert(vertices[v].in_cycle);
-    vertices[v].in_cycle = false;
+    assert(in_cycle(v));
+    set_flag(v, IN_CYCLE, false);
     if (i % 2 == 1) {
       Vtx_id u = (i == cycle.size() - 1) ? cycle[0] : cycle[i + 1];
-      if (vertices[v].is_indel) {
-        vertices[v].is_indel = false;
-        vertices[u].is_indel = false;
-        this->indel_count[vertices[v].gene_val] -= vertices[v].indel_update;
-      } else if (vertices[v].grays.size() > 1) {
-        if ((v % fhs) % 2 == 1) {
-          headtailcorresp_v = v + 1;
-        } else {
-          headtailcorresp_v = v - 1;
-        }
-        if ((u % fhs) % 2 == 1) {
-          headtailcorresp_u = u + 1;
-        } else {
-          headtailcorresp_u = u - 1;
-        }
-        if (not vertices[headtailcorresp_v].in_cycle &&
-            not vertices[headtailcorresp_u].in_cycle) {
-          assert(vertices[v].fix_gray != NO_EDGE);
-          assert(vertices[u].fix_gray != NO_EDGE);
-          assert(vertices[headtailcorresp_v].fix_gray != NO_EDGE);
-          assert(vertices[headtailcorresp_u].fix_gray != NO_EDGE);
-          vertices[v].fix_gray = NO_EDGE;
-          vertices[u].fix_gray = NO_EDGE;
-          vertices[headtailcorresp_v].fix_gray = NO_EDGE;
-          vertices[headtailcorresp_u].fix_gray = NO_EDGE;
+      if (is_indel(v)) {
+        set_flag(v, IS_INDEL, false);
+        set_flag(u, IS_INDEL, false);
+        dec.indel_count[topo->gene_val[v]] -= topo->indel_update[v];
+      } else if (grays(v).size() > 1) {
+        headtailcorresp_v = topo->indel[v];
+        headtailcorresp_u = topo->indel[u];
+        if (not in_cycle(headtailcorresp_v) &&
+            not in_cycle(headtailcorresp_u)) {
+          assert(dec.fix_gray[v] != NO_EDGE);
+          assert(dec.fix_gray[u] != NO_EDGE);
+          assert(dec.fix_gray[headtailcorresp_v] != NO_EDGE);
+          assert(dec.fix_gray[headtailcorresp_u] != NO_EDGE);
+          dec.fix_gray[v] = NO_EDGE;
+          dec.fix_gray[u] = NO_EDGE;
+          dec.fix_gray[headtailcorresp_v] = NO_EDGE;
+          dec.fix_gray[headtailcorresp_u] = NO_EDGE;
         }
       }
     }
   }
-  cycles.erase(find(cycles.begin(), cycles.end(), c));
 }
 
 bool CycleGraph::check_cycle(vector<Vtx_id> cycle) {
   for (size_t i = 0; i < cycle.size(); ++i) {
     Vtx_id v = cycle[i];
-    if (vertices[v].in_cycle) return false;
+    if (in_cycle(v)) return false;
     if (i % 2 == 1) {
       Vtx_id u = (i == cycle.size() - 1) ? cycle[0] : cycle[i + 1];
-      if (vertices[v].is_indel) {
-        if (vertices[v].indel != u) return false;
-      } else if (vertices[v].fix_gray != NO_EDGE) {
-        if (vertices[v].fix_gray != u) return false;
-      } else if (vertices[u].fix_gray != NO_EDGE) {
+      if (is_indel(v)) {
+        if (topo->indel[v] != u) return false;
+      } else if (dec.fix_gray[v] != NO_EDGE) {
+        if (dec.fix_gray[v] != u) return false;
+      } else if (dec.fix_gray[u] != NO_EDGE) {
         return false;
       }
     }
@@ -530,43 +808,36 @@ void CycleGraph::add_cycle(vector<Vtx_id> cycle) {
   assert(cycle.size() % 2 == 0);
   for (size_t i = 0; i < cycle.size(); ++i) {
     Vtx_id v = cycle[i];
-    assert(not vertices[v].in_cycle);
-    vertices[v].in_cycle = true;
-    if (i % 2 == 1 && vertices[v].fix_gray == NO_EDGE) {
+    assert(not in_cycle(v));
+    set_flag(v, IN_CYCLE, true);
+    if (i % 2 == 1 && dec.fix_gray[v] == NO_EDGE) {
       Vtx_id u = (i == cycle.size() - 1) ? cycle[0] : cycle[i + 1];
-      if (u == vertices[v].indel) {
-        vertices[v].is_indel = true;
-        vertices[u].is_indel = true;
-        this->indel_count[vertices[v].gene_val] += vertices[v].indel_update;
+      if (u == topo->indel[v]) {
+        set_flag(v, IS_INDEL, true);
+        set_flag(u, IS_INDEL, true);
+        dec.indel_count[topo->gene_val[v]] += topo->indel_update[v];
       } else {
-        assert(vertices[u].fix_gray == NO_EDGE);
-        vertices[v].fix_gray = u;
-        vertices[u].fix_gray = v;
-        if ((v % fhs) % 2 == 1) {
-          headtailcorresp_v = v + 1;
-        } else {
-          headtailcorresp_v = v - 1;
-        }
-        if ((u % fhs) % 2 == 1) {
-          headtailcorresp_u = u + 1;
-        } else {
-          headtailcorresp_u = u - 1;
-        }
-        assert(vertices[headtailcorresp_u].fix_gray == NO_EDGE);
-        assert(vertices[headtailcorresp_v].fix_gray == NO_EDGE);
-        vertices[headtailcorresp_v].fix_gray = headtailcorresp_u;
-        vertices[headtailcorresp_u].fix_gray = headtailcorresp_v;
+        assert(dec.fix_gray[u] == NO_EDGE);
+        dec.fix_gray[v] = u;
+        dec.fix_gray[u] = v;
+        headtailcorresp_v = topo->indel[v];
+        headtailcorresp_u = topo->indel[u];
+        assert(dec.fix_gray[headtailcorresp_u] == NO_EDGE);
+        assert(dec.fix_gray[headtailcorresp_v] == NO_EDGE);
+        dec.fix_gray[headtailcorresp_v] = headtailcorresp_u;
+        dec.fix_gray[headtailcorresp_u] = headtailcorresp_v;
       }
     }
   }
   int pot = cycle_potation(cycle[0]);
-  cycles.push_back(pair<size_t, Vtx_id>(cycle.size() + pot, cycle[0]));
-  /* cycles.push_back(pair<size_t, Vtx_id>(cycle.size(), cycle[0])); */
+  dec.cycles.push_back(pair<size_t, Vtx_id>(cycle.size() + pot, cycle[0]));
+  if (!cycle_at.empty()) cycle_at[cycle[0]] = dec.cycles.size() - 1;
+  /* dec.cycles.push_back(pair<size_t, Vtx_id>(cycle.size(), cycle[0])); */
 
-  indel_potation += pot;
-  /* indel_potation += cycle_potation(cycle[0]); */
+  dec.indel_potation += pot;
+  /* dec.indel_potation += cycle_potation(cycle[0]); */
   if (cycle_weight(cycle[0]) == 0) {
-    balanced_cycles++;
+    dec.balanced_cycles++;
   }
 }
 
@@ -581,34 +852,34 @@ vector<Vtx_id> CycleGraph::get_cycle(Vtx_id i) const {
 
   Vtx_id v = i;
   cycle.push_back(v);
-  v = vertices[v].black;
+  v = topo->black[v];
   cycle.push_back(v);
-  v = vertices[v].is_indel ? vertices[v].indel : vertices[v].fix_gray;
+  v = is_indel(v) ? topo->indel[v] : dec.fix_gray[v];
   while (v != cycle[0]) {
     cycle.push_back(v);
-    v = vertices[v].black;
+    v = topo->black[v];
     cycle.push_back(v);
-    v = vertices[v].is_indel ? vertices[v].indel : vertices[v].fix_gray;
+    v = is_indel(v) ? topo->indel[v] : dec.fix_gray[v];
   }
 
   return cycle;
 }
 
 int CycleGraph::cycle_weight(Vtx_id i) const {
-  int weigth = 0;
+  int w = 0;
 
   Vtx_id v = i;
   do {
-    v = vertices[v].black;
-    if (vertices[v].is_indel) {
-      v = vertices[v].indel;
+    v = topo->black[v];
+    if (is_indel(v)) {
+      v = topo->indel[v];
     } else {
-      v = vertices[v].fix_gray;
-      weigth += vertices[v].weigth;
+      v = dec.fix_gray[v];
+      w += topo->weigth[v];
     }
   } while (v != i);
 
-  return weigth;
+  return w;
 }
 
 int CycleGraph::cycle_potation(int i) const {
@@ -617,9 +888,9 @@ int CycleGraph::cycle_potation(int i) const {
 
   Vtx_id v = i;
   do {
-    v = vertices[v].black;
-    if (vertices[v].is_indel) {
-      state = vertices[v].indel_update;
+    v = topo->black[v];
+    if (is_indel(v)) {
+      state = topo->indel_update[v];
       if (last_state != state) {
         if (last_state != 0) {
           runs++;
@@ -628,9 +899,9 @@ int CycleGraph::cycle_potation(int i) const {
         }
         last_state = state;
       }
-      v = vertices[v].indel;
+      v = topo->indel[v];
     } else {
-      v = vertices[v].fix_gray;
+      v = dec.fix_gray[v];
     }
   } while (v != i);
   if (last_state != 0 && (last_state != first_state || runs == 0)) {
@@ -652,9 +923,9 @@ Run CycleGraph::cycle_run(int i) const {
   // Find one end of the run
   int first_end = -1;
   do {
-    v = vertices[v].black;
-    if (vertices[v].is_indel) {
-      state = vertices[v].indel_update;
+    v = topo->black[v];
+    if (is_indel(v)) {
+      state = topo->indel_update[v];
       if (run_state != state) {
         if (run_state == 0) {
           run_state = state;
@@ -663,9 +934,9 @@ Run CycleGraph::cycle_run(int i) const {
           break;
         }
       }
-      v = vertices[v].indel;
+      v = topo->indel[v];
     } else {
-      v = vertices[v].fix_gray;
+      v = dec.fix_gray[v];
     }
   } while (v != i);
   
@@ -673,26 +944,28 @@ Run CycleGraph::cycle_run(int i) const {
   
   bool revert = false;
   if (first_end == -1) { // single run
-    while (vertices[v].indel_update == run_state) {
-      v = vertices[v].black;
-      if (vertices[v].is_indel) {
-        v = vertices[v].indel;
+    while (topo->indel_update[v] == run_state) {
+      v = topo->black[v];
+      if (is_indel(v)) {
+        v = topo->indel[v];
       } else {
-        v = vertices[v].fix_gray;
+        v = dec.fix_gray[v];
       }
     }
     first_end = v;
   }
 
   // Get insertion position and check if the list of insertions must be inverted
-  assert(vertices[first_end].indel_update != run_state);
-  if (first_end > vertices[first_end].black) {
-    run.fst_gene = vertices[vertices[v].black].gene_val;
+  assert(topo->indel_update[first_end] != run_state);
+  if (left_end(first_end)) {
+    run.fst_gene = topo->gene_val[topo->black[v]];
   } else {
-    run.fst_gene = vertices[v].gene_val;
+    run.fst_gene = topo->gene_val[v];
     revert = true;
   }
 
+  run.adjacency = first_end;
+
   // Get genome where the insertion will occur
   if (run_state == -1) {
     run.genome = 'H';
@@ -703,22 +976,22 @@ Run CycleGraph::cycle_run(int i) const {
   // Get genes to insert
   v = first_end;
   do {
-    v = vertices[v].black;
-    if (vertices[v].is_indel) {
-      state = vertices[v].indel_update;
+    v = topo->black[v];
+    if (is_indel(v)) {
+      state = topo->indel_update[v];
       if (run_state != state) {
         break;
       }
 
-      if (vertices[v].sign_positive == (v < vertices[v].indel)) {
-        run.genes_to_add.push_back(vertices[v].gene_val);
+      if (sign_positive(v) == left_end(v)) {
+        run.genes_to_add.push_back(topo->gene_val[v]);
       } else {
-        run.genes_to_add.push_back(-vertices[v].gene_val);
+        run.genes_to_add.push_back(-topo->gene_val[v]);
       }
 
-      v = vertices[v].indel;
+      v = topo->indel[v];
     } else {
-      v = vertices[v].fix_gray;
+      v = dec.fix_gray[v];
     }
   } while (v != first_end);
   
@@ -1,7 +1,9 @@
 #pragma once
 
 #include "../misc/genome.hpp"
+#include "../misc/rng.hpp"
 #include <bitset>
+#include <cstdint>
 #include <map>
 #include <queue>
 #include <set>
@@ -9,27 +11,38 @@
 typedef int Vtx_id;
 #define NO_EDGE -1
 
-struct Vertex {
-  Vtx_id black;
-  int weigth;
-  Vtx_id fix_gray;
-  Vtx_id indel;
-  vector<Vtx_id> grays;
-  bool in_cycle;
-  bool sign_positive;
-  bool is_indel;
-  int indel_update;
-  Gene gene_val;
-  Vertex() : grays() {
-    gene_val = -1;
-    indel_update = 0;
-    is_indel = false;
-    black = NO_EDGE;
-    weigth = 0;
-    fix_gray = NO_EDGE;
-    indel = NO_EDGE;
-    in_cycle = false;
+/* Flags of a vertex */
+enum VertexFlag : uint8_t { IN_CYCLE = 1, IS_INDEL = 2 };
+
+/* Gray edges in compressed sparse row format, the neighbours of a vertex v are
+ * adj[first[v]], ..., adj[last[v] - 1]. The rows follow the order of the
+ * vertices when the graph is built, a row that grows later is moved to the
+ * end of adj. */
+struct GrayEdges {
+  vector<int> first;
+  vector<int> last;
+  vector<Vtx_id> adj;
+
+  GrayEdges() {}
+  GrayEdges(size_t n_vertices, const vector<pair<Vtx_id, Vtx_id>> &edges);
+  /* Append a vertex without gray edges. */
+  void add_vertex() {
+    first.push_back(adj.size());
+    last.push_back(adj.size());
   }
+  /* Add u to the neighbours of v. */
+  void add_edge(Vtx_id v, Vtx_id u);
+};
+
+/* Read only view of the gray edges of one vertex. */
+struct GrayRange {
+  const Vtx_id *first;
+  const Vtx_id *last;
+
+  const Vtx_id *begin() const { return first; }
+  const Vtx_id *end() const { return last; }
+  size_t size() const { return last - first; }
+  Vtx_id operator[](size_t i) const { return first[i]; }
 };
 
 struct PermsIrs {
@@ -40,101 +53,216 @@ struct PermsIrs {
   int *p_ir;
 };
 
-struct QEntry {
+/* Node of the search tree built by bfs. A node only stores the edges fixed by
+ * the step that created it and the index of its parent, the state of the whole
+ * path is recovered by following the parent links. */
+struct BfsNode {
   Vtx_id vtx;
-  map<Vtx_id, Vtx_id> fixed;
-  set<Vtx_id> vizited;
-  map<Gene, int> indel_count;
+  int parent;
+  Vtx_id v, u;              // edge followed to reach vtx
+  Vtx_id alter_v, alter_u;  // edge fixed together with (v,u) (or NO_EDGE)
+  bool indel;               // whether (v,u) is an indel edge
 
-  QEntry(Vtx_id start, map<Gene, int> indel_count)
-      : fixed(), vizited(), indel_count(indel_count) {
-    vtx = start;
-  }
+  BfsNode(Vtx_id start) : vtx(start), parent(-1), v(NO_EDGE), u(NO_EDGE),
+      alter_v(NO_EDGE), alter_u(NO_EDGE), indel(false) {}
+  BfsNode(int parent, Vtx_id v, Vtx_id u, Vtx_id alter_v, Vtx_id alter_u,
+          bool indel)
+      : vtx(u), parent(parent), v(v), u(u), alter_v(alter_v),
+        alter_u(alter_u), indel(indel) {}
+};
 
-  QEntry(Vtx_id v, Vtx_id u, Vtx_id alter_v, Vtx_id alter_u,
-         map<Vtx_id, Vtx_id> fixed_old, set<Vtx_id> vizited_old,
-         map<Gene, int> indel_count_old)
-      : fixed(fixed_old), vizited(vizited_old), indel_count(indel_count_old) {
-    vtx = u;
-    fixed[v] = u;
-    fixed[u] = v;
-    fixed[alter_v] = alter_u;
-    fixed[alter_u] = alter_v;
-    vizited.insert(u);
-    vizited.insert(v);
-  }
+/* Flat arrays used by bfs to query the state of one path of the search tree.
+ * An entry is only valid if its stamp matches the current epoch, so moving to
+ * another path does not require clearing the arrays. */
+struct BfsScratch {
+  vector<BfsNode> nodes;
+  vector<unsigned> vizited;   // per vertex, stamp of the path
+  vector<unsigned> fixed_at;  // per vertex, stamp of the path
+  vector<Vtx_id> fixed;
+  vector<unsigned> in_level;  // per vertex, stamp of the level
+  vector<unsigned> indel_at;  // per gene, stamp of the path
+  vector<int> indel_delta;
+  unsigned epoch = 0;
+  unsigned level = 0;
 
-  QEntry(Vtx_id v, Vtx_id u, map<Vtx_id, Vtx_id> fixed_old,
-         set<Vtx_id> vizited_old, map<Gene, int> indel_count_old)
-      : fixed(fixed_old), vizited(vizited_old), indel_count(indel_count_old) {
-    vtx = u;
-    fixed[v] = u;
-    fixed[u] = v;
-    vizited.insert(u);
-    vizited.insert(v);
-  }
+  void reset(size_t n_vertices, size_t n_genes);
+  /* Move to a new path. A search can expand more nodes than there are
+   * vertices, so the stamps of the path are cleared when the epoch would
+   * wrap around. */
+  void next_epoch();
 };
 
 struct Run {
   Gene fst_gene; // first gene of run
   char genome; // G or H
+  Vtx_id adjacency; // vertex of the black edge where the run is inserted
   vector<Gene> genes_to_add;
 };
 
-class CycleGraph {
-
-private:
-  int balanced_cycles = 0;
-  int indel_potation = 0;
+/* Part of the adjacency graph that does not depend on the decomposition. It is
+ * built once per instance and shared by every decomposition of the graph.
+ * Vertex 2i-3 and 2i-2 are the extremities of the gene i of the origin, and
+ * the target follows, until genes are inserted. */
+struct AdjacencyGraphTopology {
+  /* Number of vertices correspondent to genes of the origin genome */
   int fhs;
   /* Value bigger then all the labels */
   int op_max;
-  vector<Vertex> vertices;
+  /* Attributes of the vertices, one array for each attribute. */
+  vector<Vtx_id> black;
+  vector<Vtx_id> indel;
+  vector<int> weigth;
+  vector<Gene> gene_val;
+  vector<int> indel_update;
+  vector<bool> sign_positive;
+  GrayEdges grays;
+  /* Balance of each gene before any indel edge is used */
+  vector<int> indel_count;
+  /* Vertices of the caps: first and last gene of the origin and the target. */
+  Vtx_id caps[4];
+  /* Whether the vertices are still in the order of the genomes. */
+  bool in_genome_order = true;
+  /* Left extremity of the inner genes with each label, in the origin and in
+   * the target. Only built for insertions (see index_labels). */
+  vector<vector<Vtx_id>> label_genes[2];
+
+  AdjacencyGraphTopology(const Genome &origin, const Genome &target);
+  size_t size() const { return black.size(); }
+  /* Build label_genes. */
+  void index_labels();
+  /* Append the vertices of a gene of the origin (or of the target), the left
+   * extremity first, with its indel edge and its gray edges, and return the
+   * left extremity. The black edges are left to the caller. */
+  Vtx_id add_gene(Gene a, bool in_origin);
+};
+
+/* State of a cycle decomposition, this is the only part copied when a
+ * decomposition is copied. */
+struct Decomposition {
+  vector<Vtx_id> fix_gray;
+  vector<uint8_t> flags;
   vector<pair<size_t, Vtx_id>>
       cycles; // we indentify cycles by one of their vertices and their sizes
-  map<Gene, int> indel_count;
+  vector<int> indel_count;
+  int balanced_cycles = 0;
+  int indel_potation = 0;
+
+  Decomposition(const AdjacencyGraphTopology &topo);
+  /* Go back to the empty decomposition, reusing the allocated memory. */
+  void reset(const AdjacencyGraphTopology &topo);
+};
+
+class CycleGraph {
+
+private:
+  shared_ptr<const AdjacencyGraphTopology> topo;
+  Decomposition dec;
+  BfsScratch scratch; // not copied, only used inside bfs
+  /* Index in dec.cycles of the cycle starting at each vertex (or -1), only
+   * kept once genes are inserted (not copied). */
+  vector<int> cycle_at;
+
+  bool in_cycle(Vtx_id v) const { return dec.flags[v] & IN_CYCLE; }
+  bool is_indel(Vtx_id v) const { return dec.flags[v] & IS_INDEL; }
+  bool sign_positive(Vtx_id v) const { return topo->sign_positive[v]; }
+  void set_flag(Vtx_id v, VertexFlag flag, bool value) {
+    if (value) {
+      dec.flags[v] |= flag;
+    } else {
+      dec.flags[v] &= ~flag;
+    }
+  }
+  GrayRange grays(Vtx_id v) const {
+    const Vtx_id *adj = topo->grays.adj.data();
+    return GrayRange{adj + topo->grays.first[v], adj + topo->grays.last[v]};
+  }
+  /* Whether v is the left extremity of its gene, a cap only has one. */
+  bool left_end(Vtx_id v) const {
+    if (topo->indel[v] == NO_EDGE) {
+      return v == topo->caps[1] || v == topo->caps[3];
+    }
+    return v < topo->indel[v];
+  }
+  /* Topology that can be changed, copied first if other graphs share it. */
+  AdjacencyGraphTopology &own_topology();
+  /* Unflag the vertices of the cycle through vertex i and release its edges,
+   * without removing it from dec.cycles. */
+  void release_cycle(Vtx_id i);
+  /* Remove the cycle through v (if any) in O(size of the cycle), moving the
+   * last cycle to its place, and add its vertices to freed. */
+  void drop_cycle(Vtx_id v, vector<Vtx_id> &freed);
+  /* Release the gray edge fixed at v out of any cycle, which was only kept
+   * while it was the only gray edge of v. */
+  void unfix_gray(Vtx_id v);
 
-  void bfs(Vtx_id start, unique_ptr<queue<QEntry>> &q,
-           unique_ptr<set<pair<Vtx_id, int>>> &vizited_in_level,
-           bool is_random);
+  /* Load the state of the path ending in the given node into the scratch. */
+  void load_path(int node);
+  bool path_vizited(Vtx_id v) const {
+    return scratch.vizited[v] == scratch.epoch;
+  }
+  Vtx_id path_fixed(Vtx_id v) const {
+    return scratch.fixed_at[v] == scratch.epoch ? scratch.fixed[v] : NO_EDGE;
+  }
+  int path_indel_count(Gene a) const {
+    return dec.indel_count[a] +
+           (scratch.indel_at[a] == scratch.epoch ? scratch.indel_delta[a] : 0);
+  }
 
 public:
   /* Initial Constructor. */
   CycleGraph(const Genome &origin, const Genome &target);
-  /* Copy Constructor. */
-  CycleGraph(const CycleGraph &that)
-      : vertices(that.vertices), cycles(that.cycles),
-        indel_count(that.indel_count) {
-    balanced_cycles = that.balanced_cycles;
-    fhs = that.fhs;
-    op_max = that.op_max;
+  /* Empty decomposition of an existing graph. */
+  CycleGraph(shared_ptr<const AdjacencyGraphTopology> topo);
+  /* Copy Constructor (the topology is shared). */
+  CycleGraph(const CycleGraph &that) : topo(that.topo), dec(that.dec) {}
+  size_t size() const { return topo->size(); };
+  /* Remove every cycle from the decomposition. */
+  void reset() {
+    dec.reset(*topo);
+    cycle_at.clear();
   }
-  size_t size() const { return vertices.size(); };
-  void decompose_with_bfs(bool is_random);
+  shared_ptr<const AdjacencyGraphTopology> topology() const { return topo; }
+  void decompose_with_bfs(bool is_random, Rng &rng = thread_rng());
+  /* Insert the genes of each run in the genome and at the adjacency given by
+   * it, the runs must be at distinct adjacencies. The new vertices are
+   * appended to the graph and the cycles through those adjacencies or
+   * through indel edges of the inserted labels are removed, the other cycles
+   * are kept. The vertices left out of cycles are decomposed with randomized
+   * bfs, so the cost depends on the cycles removed and not on the size of
+   * the graph. Return a vertex of each new cycle. */
+  vector<Vtx_id> insert_runs(const vector<Run> &runs,
+                             Rng &rng = thread_rng());
+  /* Genes and intergenic regions of the origin (or of the target) in the
+   * order of the genome, the inserted genes included. */
+  void genome_order(bool origin, vector<Gene> &genes,
+                    vector<IR> &irs) const;
+  /* Occurrences of a label in the origin minus in the target. */
+  int label_balance(Gene a) const { return topo->indel_count[a]; }
   /* Select a cycle with a bfs
    * Arguments:
    *     start - initial vertex
    *     is_random - whether to use random approach
    */
   /* Get string with the cycles from the decomposition */
-  void bfs(Vtx_id start, bool is_random);
+  void bfs(Vtx_id start, bool is_random, Rng &rng = thread_rng());
   string show_cycles() const;
   /* Recover cycles from string */
   void read_cycles(string);
-  /* Recover permutations from decomposition */
+  /* Recover permutations from decomposition, the graph must not have
+   * inserted genes. */
   PermsIrs get_perms();
   /* Get number of cycles from the decomposition */
-  int dec_size() const { return cycles.size(); }
-  int dec_balanced_cycles() const { return balanced_cycles; }
+  int dec_size() const { return dec.cycles.size(); }
+  int dec_balanced_cycles() const { return dec.balanced_cycles; }
   void rem_cycle(pair<size_t, Vtx_id> c);
   /* Get indel potation */
-  int potation() const { return indel_potation; }
+  int potation() const { return dec.indel_potation; }
   /* Verify if a cycle can be added */
   bool check_cycle(vector<Vtx_id> cycle);
   void add_cycle(vector<Vtx_id> cycle);
   void check_and_add_cycle(vector<Vtx_id> cycle);
 
-  vector<pair<size_t, Vtx_id>> cycle_list() const { return cycles; }
+  vector<pair<size_t, Vtx_id>> cycle_list() const { return dec.cycles; }
   vector<Vtx_id> get_cycle(Vtx_id i) const;
   int cycle_weight(Vtx_id i) const;
   int cycle_potation(Vtx_id i) const;
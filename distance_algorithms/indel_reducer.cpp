@@ -0,0 +1,126 @@
+#include "indel_reducer.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+#include "../cycle/cycles.hpp"
+
+int IndelReducer::balanced_labels(InputData &data) {
+  unordered_map<int,int> alp;
+  data.g->alphabet(alp,false);
+  data.h->alphabet(alp,true);
+  int inter = 0;
+  for (auto el : alp) {
+    if (el.second == 0) inter++;
+  }
+  return inter;
+}
+
+int IndelReducer::lower_bound(int balanced, const CycleGraph &cg) {
+  return balanced - cg.dec_size() + cg.potation() - 1;
+}
+
+/* Update the number of balanced labels for the insertion of a run, the
+ * labels of a run are distinct. */
+static void update_balanced(int &balanced, const CycleGraph &cg,
+                            const Run &run) {
+  int delta = (run.genome == 'G') ? 1 : -1;
+  for (Gene a : run.genes_to_add) {
+    int count = cg.label_balance(abs(a));
+    if (count + delta == 0) {
+      balanced++;
+    } else if (count == 0) {
+      balanced--;
+    }
+  }
+}
+
+/* Genome read along the graph, with the alpha genes of the genome before the
+ * insertions (the inserted genes are not alpha). */
+static Genome *inserted_genome(const CycleGraph &cg, bool origin,
+                               const Genome &before) {
+  vector<Gene> labels;
+  vector<IR> irs;
+  cg.genome_order(origin, labels, irs);
+  vector<Genea> genes;
+  for (Gene a : labels) {
+    const vector<int> &pos = before.pos(a);
+    genes.push_back(Genea(a, !pos.empty() && before.check_alpha(pos[0])));
+  }
+  return new Genome(genes, irs);
+}
+
+int IndelReducer::insert_runs(InputData &data, Rng &rng) const {
+  CycleGraph cg(*data.g, *data.h);
+  cg.decompose_with_bfs(true, rng);
+  int balanced = balanced_labels(data);
+  int runs = 0;
+#ifndef NDEBUG
+  int last_lb = lower_bound(balanced, cg);
+#endif
+
+  /* A vertex of each cycle that may have a run, the cycles not touched by an
+   * insertion keep their runs. Batched runs take every pending cycle at
+   * once, their runs are at distinct adjacencies and use distinct labels. */
+  vector<Vtx_id> pending;
+  for (auto &c : cg.cycle_list()) {
+    pending.push_back(c.second);
+  }
+  vector<Run> round;
+  while (!pending.empty()) {
+    round.clear();
+    while (!pending.empty() && (batch_runs || round.empty())) {
+      Run run = cg.cycle_run(pending.back());
+      pending.pop_back();
+      if (!run.genes_to_add.empty()) round.push_back(move(run));
+    }
+    if (round.empty()) break;
+
+    /* The labels are distinct, so the counts can be updated before
+     * inserting any of them. */
+    for (const Run &run : round) {
+      update_balanced(balanced, cg, run);
+    }
+    vector<Vtx_id> added = cg.insert_runs(round, rng);
+    pending.insert(pending.end(), added.begin(), added.end());
+    runs += round.size();
+#ifndef NDEBUG
+    /* Every run inserted must decrease the lower bound. */
+    int lb = lower_bound(balanced, cg);
+    assert(lb < last_lb);
+    last_lb = lb;
+#endif
+  }
+
+  /* The genomes are read from the graph once, instead of inserting each
+   * run in them. */
+  if (runs > 0) {
+    data.g.reset(inserted_genome(cg, true, *data.g));
+    data.h.reset(inserted_genome(cg, false, *data.h));
+  }
+  assert(balanced == balanced_labels(data));
+  assert(CycleGraph(*data.g, *data.h).size() == cg.size());
+  return runs;
+}
+
+ReducedInstance IndelReducer::reduce(const Permutation &pi,
+                                     Rng &rng) const {
+  ReducedInstance r;
+
+  assert(pi.occ_max() == 1);
+  r.data = pi.split_iota(); // create a permutation iota (except the last gene is bigger than any gene in pi)
+  r.indels = insert_runs(r.data, rng);
+
+  assert(r.data.g->size() == r.data.h->size());
+  assert(r.data.g->balanced(*r.data.h));
+  assert(r.data.g->occ_max() == 1);
+
+  int *g_perm = r.data.g->get_perm();
+  int *h_perm = r.data.h->get_perm();
+  r.g_perm.assign(g_perm, g_perm + r.data.g->size());
+  r.h_perm.assign(h_perm, h_perm + r.data.h->size());
+  delete[] g_perm;
+  delete[] h_perm;
+
+  return r;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "../misc/io.hpp"
+#include "../misc/permutation.hpp"
+#include "../misc/rng.hpp"
+
+class CycleGraph;
+
+/* Instance after the removal of the indels: balanced genomes without
+ * replicated labels, the number of indel operations used to reach them, and
+ * the genomes as the arrays taken by the sorting algorithms. */
+struct ReducedInstance {
+  InputData data;
+  int indels = 0;
+  vector<int> g_perm;
+  vector<int> h_perm;
+
+  int size() const { return g_perm.size(); }
+};
+
+/* First stage of the distance algorithms for permutations with indels. The
+ * runs of indels found in cycle decompositions are inserted until the genomes
+ * are balanced, the result can be consumed by several sorting algorithms. */
+class IndelReducer {
+  /* Whether all the runs of a decomposition are inserted before the cycle
+   * graph is updated, instead of one run at a time. */
+  bool batch_runs;
+
+  /* Insert the runs of indels found in cycle decompositions until there are
+   * none left, return the number of runs inserted. The runs are inserted in
+   * the cycle graph (see CycleGraph::insert_runs) and the genomes are read
+   * from it at the end. */
+  int insert_runs(InputData &data, Rng &rng) const;
+
+public:
+  IndelReducer(bool batch_runs = false) : batch_runs(batch_runs) {}
+  ReducedInstance reduce(const Permutation &pi,
+                         Rng &rng = thread_rng()) const;
+  /* Number of labels with the same number of occurrences in both genomes */
+  static int balanced_labels(InputData &data);
+  /* Lower bound for the number of operations, each run inserted must
+   * decrease it. */
+  static int lower_bound(int balanced, const CycleGraph &cg);
+};
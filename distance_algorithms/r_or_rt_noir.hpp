@@ -2,23 +2,29 @@
 
 #include "../misc/dist.hpp"
 #include "../misc/permutation.hpp"
+#include "indel_reducer.hpp"
 
 class R_OR_RT_NOIR : public DistAlg {
+  IndelReducer reducer;
+
 public:
+  R_OR_RT_NOIR(bool batch_runs = false) : reducer(batch_runs) {}
   int estimate_distance(Permutation pi) override;
+  /* Distance of an instance already reduced, so the same reduction can be
+   * shared by several algorithms. */
+  int estimate_distance(const ReducedInstance &r);
   InputData make_genomes(Permutation pi);
-  virtual int dist_aux(int *g1, int *g2, int size) = 0;
-  virtual int lower_bound(InputData &data, unique_ptr<CycleGraph> &cg) = 0;
+  virtual int dist_aux(const int *g1, const int *g2, int size) = 0;
 };
 
 class ReversalNOIR : public R_OR_RT_NOIR {
 public:
-  int dist_aux(int *g1, int *g2, int size) override;
-  int lower_bound(InputData &data, unique_ptr<CycleGraph> &cg) override;
+  using R_OR_RT_NOIR::R_OR_RT_NOIR;
+  int dist_aux(const int *g1, const int *g2, int size) override;
 };
 
 class ReversalTranspositionNOIR : public R_OR_RT_NOIR {
 public:
-  int dist_aux(int *g1, int *g2, int size) override;
-  int lower_bound(InputData &data, unique_ptr<CycleGraph> &cg) override;
+  using R_OR_RT_NOIR::R_OR_RT_NOIR;
+  int dist_aux(const int *g1, const int *g2, int size) override;
 };
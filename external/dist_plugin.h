@@ -0,0 +1,40 @@
+#pragma once
+
+/* C interface of the distance plugins, shared libraries loaded by dist that
+ * receive the same data the external programs receive as arguments: the
+ * permutation (n genes), the target intergenic regions and the origin
+ * intergenic regions (n - 1 values each).
+ *
+ * Both entry points are called concurrently by the threads of dist, on
+ * different permutations, so they must not modify shared state without
+ * synchronization. The library is loaded once for each time it appears in
+ * the list of algorithms and stays loaded until dist exits.
+ *
+ * The arrays belong to dist and are only valid during the call: the plugin
+ * must not modify them or keep pointers to them. The only array written by
+ * the plugin is dists, which has count entries. external/sample_plugin.c is
+ * a minimal plugin. */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Name of the entry point every plugin must export. */
+#define DIST_PLUGIN_ENTRY "dist_estimate"
+/* Name of the optional entry point for many permutations at once. */
+#define DIST_PLUGIN_BATCH_ENTRY "dist_estimate_batch"
+
+/* Return the distance of one permutation. */
+typedef int (*dist_plugin_fn)(const int *perm, int n, const int *target_irs,
+                              const int *origin_irs);
+
+/* Write in dists the distances of count permutations, the i-th one has ns[i]
+ * genes. */
+typedef void (*dist_plugin_batch_fn)(int count, const int *const *perms,
+                                     const int *ns,
+                                     const int *const *target_irs,
+                                     const int *const *origin_irs, int *dists);
+
+#ifdef __cplusplus
+}
+#endif
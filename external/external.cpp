@@ -1,11 +1,143 @@
 #include "external.hpp"
+#include <atomic>
+#include <cerrno>
+#include <csignal>
 #include <cstdio>
+#include <fcntl.h>
+#include <pthread.h>
 #include <sstream>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/* Write all of data to fd. SIGPIPE is blocked by the calling thread during
+ * the write, so a program that exited makes the write fail with EPIPE
+ * instead of killing us, and the signal raised by it is discarded. */
+static bool write_all(int fd, const string &data) {
+  sigset_t pipe_set, old_set;
+  sigemptyset(&pipe_set);
+  sigaddset(&pipe_set, SIGPIPE);
+  pthread_sigmask(SIG_BLOCK, &pipe_set, &old_set);
+
+  size_t written = 0;
+  bool broken = false;
+  while (written < data.size()) {
+    ssize_t w = write(fd, data.data() + written, data.size() - written);
+    if (w < 0 && errno == EINTR) continue;
+    if (w < 0) {
+      broken = (errno == EPIPE);
+      break;
+    }
+    written += w;
+  }
+
+  if (broken && !sigismember(&old_set, SIGPIPE)) {
+    timespec now = {0, 0};
+    sigtimedwait(&pipe_set, NULL, &now);
+  }
+  pthread_sigmask(SIG_SETMASK, &old_set, NULL);
+  return written == data.size();
+}
+
+bool ExternalDistAlg::Worker::start(const string &prog) {
+  int to_child[2], from_child[2];
+  /* The pipes are closed on exec, so workers of other threads do not keep
+   * them open. */
+  if (pipe2(to_child, O_CLOEXEC) != 0) return false;
+  if (pipe2(from_child, O_CLOEXEC) != 0) {
+    close(to_child[0]);
+    close(to_child[1]);
+    return false;
+  }
+  pid_t child = fork();
+  if (child == 0) {
+    dup2(to_child[0], STDIN_FILENO);
+    dup2(from_child[1], STDOUT_FILENO);
+    execl(prog.c_str(), prog.c_str(), (char *)NULL);
+    _exit(127);
+  }
+  close(to_child[0]);
+  close(from_child[1]);
+  if (child < 0) {
+    close(to_child[1]);
+    close(from_child[0]);
+    return false;
+  }
+  pid = child;
+  in = to_child[1];
+  out = fdopen(from_child[0], "r");
+  return true;
+}
+
+bool ExternalDistAlg::Worker::ask(const string &line, int &dist) {
+  return in >= 0 && out && write_all(in, line + "\n") &&
+         fscanf(out, "%d", &dist) == 1;
+}
+
+void ExternalDistAlg::Worker::stop() {
+  if (in >= 0) close(in);
+  if (out) fclose(out);
+  if (pid > 0) waitpid(pid, NULL, 0);
+  in = -1;
+  out = nullptr;
+  pid = -1;
+}
+
+ExternalDistAlg::ExternalDistAlg(string prog, bool persistent)
+    : prog(prog), persistent(persistent) {
+  static atomic<size_t> next_id(0);
+  id = next_id++;
+}
+
+ExternalDistAlg::Worker &ExternalDistAlg::worker() {
+  /* Workers of the calling thread, by the id of their algorithm. Ids are
+   * never reused, so the entries of destroyed algorithms are never found. */
+  thread_local vector<pair<size_t, Worker *>> slots;
+  for (auto &slot : slots) {
+    if (slot.first == id) return *slot.second;
+  }
+
+  Worker *w = new Worker();
+  {
+    lock_guard<mutex> guard(workers_lock);
+    workers.emplace_back(w);
+  }
+  slots.emplace_back(id, w);
+  if (!w->start(prog)) w->stop();
+  return *w;
+}
+
+int ExternalDistAlg::one_shot(const string &args) {
+  int dist;
+  if (persistent) {
+    /* The instance goes through stdin, long genomes do not fit in the
+     * command line. */
+    Worker w;
+    if (!w.start(prog)) {
+      throw runtime_error("Error calling child process.");
+    }
+    if (!w.ask(args, dist)) {
+      throw runtime_error("Error on child process.");
+    }
+    return dist;
+  }
+
+  FILE *prog_pipe;
+  if ((prog_pipe = popen((prog + " " + args).c_str(), "r")) == NULL) {
+    throw runtime_error("Error calling child process.");
+  }
+  if (fscanf(prog_pipe, "%d", &dist) != 1) {
+    pclose(prog_pipe);
+    throw runtime_error("Error on child process.");
+  }
+  if (pclose(prog_pipe) != EXIT_SUCCESS) {
+    throw runtime_error("Error on child process.");
+  }
+  return dist;
+}
 
 int ExternalDistAlg::estimate_distance(Permutation pi) {
   int dist;
   stringstream ss;
-  ss << prog << " ";
   for (size_t i = 1; i < pi.size(); i++) {
     ss << pi[i] << ",";
   }
@@ -18,13 +150,14 @@ int ExternalDistAlg::estimate_distance(Permutation pi) {
     ss << pi.get_ir(i) << ",";
   }
   ss << pi.get_ir(pi.size() - 1);
-  FILE *prog_pipe;
-  if ((prog_pipe = popen(ss.str().c_str(), "r")) == NULL) {
-    throw runtime_error("Error calling child process.");
-  }
-  fscanf(prog_pipe, "%d", &dist);
-  if (pclose(prog_pipe) != EXIT_SUCCESS) {
-    throw runtime_error("Error on child process.");
+  string args = ss.str();
+
+  if (persistent) {
+    Worker &w = worker();
+    if (w.ask(args, dist)) {
+      return dist;
+    }
+    w.stop();
   }
-  return dist;
+  return one_shot(args);
 }
@@ -1,14 +1,50 @@
 #pragma once
 #include "../misc/dist.hpp"
+#include <cstdio>
+#include <mutex>
+#include <sys/types.h>
 
 /* Call to an external program to calculate the distances. The program must
  * receive three comma separated list as command line arguments (the
  * permutation, the target intergenic regions, and the origin intergenic
- * regions). The program must print the distance to its stdout.*/
+ * regions). The program must print the distance to its stdout.
+ *
+ * In the persistent mode the program is started without arguments, once for
+ * each thread, and must read one instance per line from its stdin (the three
+ * lists separated by spaces) and print one distance per line, flushing its
+ * output after each one. If a worker fails the instance is solved by a new
+ * process that receives only that line on its stdin, and so are the next
+ * instances of the same thread. */
 class ExternalDistAlg : public DistAlg {
+  /* Program started without arguments, connected by pipes. */
+  struct Worker {
+    pid_t pid = -1;
+    int in = -1;         // stdin of the program
+    FILE *out = nullptr; // stdout of the program
+
+    /* Start the program, returns false if it could not be started. */
+    bool start(const string &prog);
+    /* Send one line to the program and read the distance it answers. */
+    bool ask(const string &line, int &dist);
+    /* Close the stdin of the program and wait for it to exit. */
+    void stop();
+    ~Worker() { stop(); }
+  };
+
   string prog;
+  bool persistent;
+  /* Distinguishes the instances in the per-thread worker slots. */
+  size_t id;
+  /* The workers of all threads, stopped with the algorithm. */
+  mutex workers_lock;
+  vector<unique_ptr<Worker>> workers;
+
+  /* Worker of the calling thread, started on the first call. The worker is
+   * stopped if the program could not be started. */
+  Worker &worker();
+  int one_shot(const string &args);
 
 public:
-  ExternalDistAlg(string prog) : prog(prog){};
+  ExternalDistAlg(string prog, bool persistent = false);
   int estimate_distance(Permutation pi) override;
 };
@@ -0,0 +1,64 @@
+#include "plugin.hpp"
+#include <dlfcn.h>
+#include <stdexcept>
+
+/* Arrays of a permutation in the layout of the plugin interface. */
+struct PluginArgs {
+  vector<int> perm;
+  vector<int> target_irs;
+  vector<int> origin_irs;
+
+  PluginArgs(const Permutation &pi) {
+    for (size_t i = 1; i <= pi.size(); i++) {
+      perm.push_back(pi[i]);
+    }
+    for (size_t i = 1; i < pi.size(); i++) {
+      target_irs.push_back(pi.get_ir_target(i));
+      origin_irs.push_back(pi.get_ir(i));
+    }
+  }
+};
+
+PluginDistAlg::PluginDistAlg(const string &lib) {
+  handle = dlopen(lib.c_str(), RTLD_NOW | RTLD_LOCAL);
+  if (handle == NULL) {
+    throw invalid_argument("Could not load plugin " + lib + ": " + dlerror());
+  }
+  fn = (dist_plugin_fn)dlsym(handle, DIST_PLUGIN_ENTRY);
+  if (fn == NULL) {
+    dlclose(handle);
+    throw invalid_argument("Plugin " + lib + " does not export " +
+                           DIST_PLUGIN_ENTRY + ".");
+  }
+  batch_fn = (dist_plugin_batch_fn)dlsym(handle, DIST_PLUGIN_BATCH_ENTRY);
+}
+
+PluginDistAlg::~PluginDistAlg() { dlclose(handle); }
+
+int PluginDistAlg::estimate_distance(Permutation pi) {
+  PluginArgs args(pi);
+  return fn(args.perm.data(), args.perm.size(), args.target_irs.data(),
+            args.origin_irs.data());
+}
+
+void PluginDistAlg::estimate_distances(const vector<const Permutation *> &pis,
+                                       vector<int> &dists) {
+  if (batch_fn == nullptr) {
+    DistAlg::estimate_distances(pis, dists);
+    return;
+  }
+  vector<PluginArgs> args;
+  vector<const int *> perms, target_irs, origin_irs;
+  vector<int> ns;
+  args.reserve(pis.size());
+  for (const Permutation *pi : pis) {
+    args.emplace_back(*pi);
+    perms.push_back(args.back().perm.data());
+    ns.push_back(args.back().perm.size());
+    target_irs.push_back(args.back().target_irs.data());
+    origin_irs.push_back(args.back().origin_irs.data());
+  }
+  dists.assign(pis.size(), 0);
+  batch_fn(pis.size(), perms.data(), ns.data(), target_irs.data(),
+           origin_irs.data(), dists.data());
+}
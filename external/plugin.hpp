@@ -0,0 +1,23 @@
+#pragma once
+#include "../misc/dist.hpp"
+#include "dist_plugin.h"
+
+/* Distances calculated by a shared library loaded with dlopen, without
+ * starting processes or formatting the instances as text. The library must
+ * export the entry points described in dist_plugin.h. */
+class PluginDistAlg : public DistAlg {
+  void *handle;
+  dist_plugin_fn fn;
+  dist_plugin_batch_fn batch_fn;
+
+public:
+  /* Throws invalid_argument if the library or its entry point is missing. */
+  PluginDistAlg(const string &lib);
+  ~PluginDistAlg();
+  PluginDistAlg(const PluginDistAlg &) = delete;
+  PluginDistAlg &operator=(const PluginDistAlg &) = delete;
+  int estimate_distance(Permutation pi) override;
+  void estimate_distances(const vector<const Permutation *> &pis,
+                          vector<int> &dists) override;
+  bool batched() const override { return batch_fn != nullptr; }
+};
@@ -0,0 +1,26 @@
+/* Minimal distance plugin, used by the tests: the distance is the number of
+ * breakpoints of the permutation, pairs of consecutive genes that are not
+ * adjacent in the identity, plus one for each intergenic region whose size
+ * differs between the genomes. Built without DIST_SAMPLE_BATCH it only
+ * exports the entry point for a single permutation. */
+#include "dist_plugin.h"
+
+int dist_estimate(const int *perm, int n, const int *target_irs,
+                  const int *origin_irs) {
+  int dist = 0;
+  for (int i = 0; i + 1 < n; i++) {
+    if (perm[i + 1] != perm[i] + 1) dist++;
+    if (target_irs[i] != origin_irs[i]) dist++;
+  }
+  return dist;
+}
+
+#ifdef DIST_SAMPLE_BATCH
+void dist_estimate_batch(int count, const int *const *perms, const int *ns,
+                         const int *const *target_irs,
+                         const int *const *origin_irs, int *dists) {
+  for (int i = 0; i < count; i++) {
+    dists[i] = dist_estimate(perms[i], ns[i], target_irs[i], origin_irs[i]);
+  }
+}
+#endif
@@ -10,14 +10,17 @@ bool cmp_chr(const unique_ptr<Chromossome> &c1,
   return c1->fitness() > c2->fitness();
 }
 
-int GA::select_parent() {
-  int best_index = rand() % population->size();
+int GA::select_parent(Rng &rng) {
+  int best_index = rng.below(population->size());
+  Fitness best_fit = (*population)[best_index]->fitness();
   for (int i = 0; i < tournament_size; i++) {
-      int index = rand() % population->size();
-      if ((*population)[index]->fitness() > (*population)[best_index]->fitness()) {
+      int index = rng.below(population->size());
+      Fitness fit = (*population)[index]->fitness();
+      if (fit > best_fit) {
           best_index = index;
-      } else if ((*population)[index]->fitness() == (*population)[best_index]->fitness()) {
-          if (rand() % 2 == 0) {
+          best_fit = fit;
+      } else if (fit == best_fit) {
+          if (rng.below(2) == 0) {
               best_index = index;
           }
       }
@@ -27,7 +30,7 @@ int GA::select_parent() {
 
 void GA::select_population(unique_ptr<Population> &mutants) {
   // Find worse mutant.
-  vector<int> worse_obj = (*mutants)[0]->fitness();
+  Fitness worse_obj = (*mutants)[0]->fitness();
   int worse_idx = 0;
   for (size_t i = 1; i < mutants->size(); ++i) {
     if ((*mutants)[i]->fitness() < worse_obj) {
@@ -37,7 +40,7 @@ void GA::select_population(unique_ptr<Population> &mutants) {
   }
 
   // Find best chromosome from the original population.
-  vector<int> best_obj = (*population)[0]->fitness();
+  Fitness best_obj = (*population)[0]->fitness();
   int best_idx = 0;
   for (size_t i = 1; i < population->size(); ++i) {
     if ((*population)[i]->fitness() < best_obj) {
@@ -88,19 +91,19 @@ bool GA::eval_population(unique_ptr<Population> &new_population, Timer timer) {
 
 /* We include cycles from the original decompositions ignoring conflicts.
  * Afterwards we use bfs to find new cycles. */
-Chromossome *GA::crossover(const Chromossome &chr1,
-                           const Chromossome &chr2) const {
+Chromossome *GA::crossover(const Chromossome &chr1, const Chromossome &chr2,
+                           Rng &rng) const {
   auto c_list1 = vector<pair<size_t, Vtx_id>>(chr1.cycle_list());
   auto c_list2 = vector<pair<size_t, Vtx_id>>(chr2.cycle_list());
   Chromossome *chr = new Chromossome(*original);
 
-  random_shuffle(c_list1.begin(), c_list1.end());
-  random_shuffle(c_list2.begin(), c_list2.end());
+  shuffle(c_list1.begin(), c_list1.end(), rng);
+  shuffle(c_list2.begin(), c_list2.end(), rng);
   /* sort(c_list1.begin(), c_list1.end()); */
   /* sort(c_list2.begin(), c_list2.end()); */
 
   while (c_list1.size() > 0 && c_list2.size() > 0) {
-    double p = (double)rand() / RAND_MAX;
+    double p = rng.real();
     if (p < crossover_rate) {
       chr->check_and_add_cycle(chr1.get_cycle(c_list1.back().second));
       c_list1.pop_back();
@@ -120,18 +123,36 @@ Chromossome *GA::crossover(const Chromossome &chr1,
     c_list2.pop_back();
   }
 
-  chr->decompose_with_bfs(true);
+  chr->decompose_with_bfs(true, rng);
   return chr;
 }
 
 /* For each cycle we have a chance equals to mutation_rate to removed.
  * Afterwards we use bfs to find new cycles. */
-void GA::mutation(unique_ptr<Chromossome> &chr) const {
+void GA::mutation(unique_ptr<Chromossome> &chr, Rng &rng) const {
   for (auto c : chr->cycle_list()) {
-    double p = (double)rand() / RAND_MAX;
+    double p = rng.real();
     if (p < mutation_rate) {
       chr->rem_cycle(c);
     }
   }
-  chr->decompose_with_bfs(true);
+  chr->decompose_with_bfs(true, rng);
+}
+
+unique_ptr<Chromossome> GA::emigrant() const {
+  return unique_ptr<Chromossome>(new Chromossome(*best_chr));
+}
+
+void GA::immigrate(const Chromossome &chr) {
+  int worse_idx = 0;
+  for (size_t i = 1; i < population->size(); ++i) {
+    if ((*population)[i]->fitness() < (*population)[worse_idx]->fitness()) {
+      worse_idx = i;
+    }
+  }
+  (*population)[worse_idx].reset(new Chromossome(chr));
+  if (chr.fitness() > best_obj) {
+    best_obj = chr.fitness();
+    best_chr.reset(new Chromossome(chr));
+  }
 }
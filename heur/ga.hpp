@@ -7,20 +7,22 @@
 #include <vector>
 
 #include "../cycle/cycles.hpp"
+#include "../misc/rng.hpp"
 #include "../misc/timer.hpp"
 #include "solution.hpp"
 using namespace std;
 
+typedef int Fitness;
+
 class Chromossome : public CycleGraph {
  public:
   Chromossome(const Chromossome &chr) : CycleGraph(chr) {}
   Chromossome(const CycleGraph &cg) : CycleGraph(cg) {}
-  vector<int> fitness() {
-    vector<int> fit(1);
-    /* fit[0] = this->dec_balanced_cycles(); */
-    /* fit[1] = this->dec_size() - this->potation(); */
-    fit[0] = this->dec_size() - this->potation();
-    return fit;
+  /* The number of cycles and the indel potation are updated by add_cycle and
+   * rem_cycle, so the fitness is available in constant time. */
+  Fitness fitness() const {
+    /* return this->dec_balanced_cycles(); */
+    return this->dec_size() - this->potation();
   };
 };
 typedef vector<unique_ptr<Chromossome>> Population;
@@ -37,20 +39,26 @@ class GA {
   double crossover_rate;
   int tournament_size;
   int population_size;
-  vector<int> best_obj;
+  Fitness best_obj;
   int generations;
+  int generations_done = 0;
+  int iterations_done = 0;  // number of decompositions generated
+  /* Each decomposition generated uses its own stream of this seed, so the
+   * result does not depend on the threads running the GA. */
+  uint64_t seed;
   ostream *os;
 
-  int select_parent();  // Returns index of next selected parent
+  int select_parent(Rng &);  // Returns index of next selected parent
   void select_population(unique_ptr<Population> &mutants);
   bool eval_population(unique_ptr<Population> &, Timer);
-  Chromossome *crossover(const Chromossome &, const Chromossome &) const;
-  void mutation(unique_ptr<Chromossome> &) const;
+  Chromossome *crossover(const Chromossome &, const Chromossome &,
+                         Rng &) const;
+  void mutation(unique_ptr<Chromossome> &, Rng &) const;
 
  public:
   GA(Chromossome *chr, double mutation_rate, double crossover_rate, int tournament_size,
      int initial_size, int population_size, int generations, ostream *os,
-     Timer timer) {
+     Timer timer, uint64_t seed) {
     this->original = unique_ptr<Chromossome>(chr);
     this->population_size = population_size;
     this->population = unique_ptr<Population>(new Population(initial_size));
@@ -58,15 +66,18 @@ class GA {
     this->crossover_rate = crossover_rate;
     this->tournament_size = tournament_size;
     this->generations = generations;
+    this->seed = seed;
     this->os = os;
 
 #pragma omp parallel for // Create each chromosomes in parallel
     for (int i = 0; i < initial_size; ++i) {
+      Rng rng(seed, i);
       (*population)[i] = unique_ptr<Chromossome>(new Chromossome(*original));
-      (*population)[i]->decompose_with_bfs(true);
+      (*population)[i]->decompose_with_bfs(true, rng);
     }
 
-    best_obj = vector<int>(2, numeric_limits<int>::min());
+    best_obj = numeric_limits<Fitness>::min();
+    iterations_done = initial_size;
     eval_population(population, timer);
     /* sort(population->begin(), population->end(), cmp_chr); */
     /* random_shuffle(population->begin() + population_size / 2,
@@ -74,40 +85,55 @@ class GA {
     /* population->resize(population_size); */
   }
 
-  vector<int> get_best_obj() { return best_obj; }
+  Fitness get_best_obj() { return best_obj; }
   unique_ptr<Chromossome> get_best_chr() { return move(best_chr); }
-
-  void solve(Timer timer) {
+  int get_generations() const { return generations_done; }
+  int get_iterations() const { return iterations_done; }
+  /* Copy of the best chromosome found so far, to be sent to another GA */
+  unique_ptr<Chromossome> emigrant() const;
+  /* Replace the worst chromosome of the population with the given one */
+  void immigrate(const Chromossome &chr);
+
+  void solve(Timer timer) { evolve(generations, timer); }
+
+  /* Run the given number of generations (less if the time runs out) and
+   * return how many were run. */
+  int evolve(int n_generations, Timer timer) {
     unique_ptr<Population> offsprings = nullptr;
     /* int last_impr_gen = 0; */
+    int g;
 
-    for (int g = 1; g <= generations; g++) {
+    for (g = 1; g <= n_generations; g++) {
       bool improved = false;
 
+      // Stop after runing out of time
+      if (timer.done()) {
+        break;
+      }
+
       offsprings.reset(new Population(population_size));
 
 #pragma omp parallel for // Create each chromosomes in parallel
       for (int i = 0; i < population_size; i++) {
-        unique_ptr<Chromossome> &chr1 = (*population)[select_parent()];
-        unique_ptr<Chromossome> &chr2 = (*population)[select_parent()];
-        (*offsprings)[i] = unique_ptr<Chromossome>(crossover(*chr1, *chr2));
-        mutation((*offsprings)[i]);
+        Rng rng(seed, iterations_done + i);
+        unique_ptr<Chromossome> &chr1 = (*population)[select_parent(rng)];
+        unique_ptr<Chromossome> &chr2 = (*population)[select_parent(rng)];
+        (*offsprings)[i] = unique_ptr<Chromossome>(crossover(*chr1, *chr2, rng));
+        mutation((*offsprings)[i], rng);
       }
       improved = improved || eval_population(offsprings, timer);
 
       // Save new selected chromosomes in population and delete the old ones
       select_population(offsprings);
+      generations_done++;
+      iterations_done += population_size;
 
       // Stop after given number of generations without improvement
       /* if (improved) last_impr_gen = g; */
       /* if (g - last_impr_gen == 100) { */
       /* 	break; */
       /* } */
-
-      // Stop after runing out of time
-      /* if (timer.done()) { */
-      /* 	break; */
-      /* } */
     }
+    return g - 1;
   }
 };
@@ -0,0 +1,97 @@
+#include "island_ga.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+#include "../misc/rng.hpp"
+
+IslandGA::IslandGA(Chromossome *chr, int n_islands, int migration_interval,
+                   bool random_topology, double mutation_rate,
+                   double crossover_rate, int tournament_size,
+                   int population_size, int generations, Timer timer)
+    : islands(n_islands) {
+  unique_ptr<Chromossome> original(chr);
+  this->generations = generations;
+  this->migration_interval = max(migration_interval, 1);
+  this->random_topology = random_topology;
+
+  /* The seed is read here, the threads of the loop below may not see a
+   * seed set for the calling thread. */
+  uint64_t seed = get_seed();
+#pragma omp parallel for schedule(static, 1) // Create each island in parallel
+  for (int i = 0; i < n_islands; ++i) {
+    islands[i] = unique_ptr<GA>(new GA(
+        new Chromossome(*original), mutation_rate, crossover_rate,
+        tournament_size, population_size, population_size, generations,
+        nullptr, timer, derive_seed(seed, i)));
+  }
+}
+
+void IslandGA::migrate(int round) {
+  int n = islands.size();
+  vector<unique_ptr<Chromossome>> emigrants(n);
+  for (int i = 0; i < n; ++i) {
+    emigrants[i] = islands[i]->emigrant();
+  }
+
+  vector<int> source(n);
+  iota(source.begin(), source.end(), 0);
+  if (random_topology) {
+    Rng rng = task_rng(round);
+    shuffle(source.begin(), source.end(), rng);
+  } else {
+    rotate(source.begin(), source.end() - 1, source.end());
+  }
+
+  for (int i = 0; i < n; ++i) {
+    if (source[i] != i) {
+      islands[i]->immigrate(*emigrants[source[i]]);
+    }
+  }
+}
+
+void IslandGA::solve(Timer timer) {
+  int n = islands.size();
+  for (int round = 0; generations_done < generations; ++round) {
+    int epoch = min(migration_interval, generations - generations_done);
+    vector<int> done(n);
+
+    /* Islands only synchronize at migrations. */
+#pragma omp parallel for schedule(static, 1)
+    for (int i = 0; i < n; ++i) {
+      done[i] = islands[i]->evolve(epoch, timer);
+    }
+    generations_done += *min_element(done.begin(), done.end());
+
+    if (timer.done() || generations_done >= generations) {
+      break;
+    }
+    migrate(round);
+  }
+}
+
+Fitness IslandGA::get_best_obj() {
+  Fitness best = islands[0]->get_best_obj();
+  for (auto &island : islands) {
+    best = max(best, island->get_best_obj());
+  }
+  return best;
+}
+
+unique_ptr<Chromossome> IslandGA::get_best_chr() {
+  int best = 0;
+  for (size_t i = 1; i < islands.size(); ++i) {
+    if (islands[i]->get_best_obj() > islands[best]->get_best_obj()) {
+      best = i;
+    }
+  }
+  return islands[best]->get_best_chr();
+}
+
+int IslandGA::get_iterations() const {
+  int iterations = 0;
+  for (auto &island : islands) {
+    iterations += island->get_iterations();
+  }
+  return iterations;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "ga.hpp"
+using namespace std;
+
+/* Island model: several GAs (islands) evolve independently and, every
+ * migration_interval generations, each island sends a copy of its best
+ * chromosome to another island, where it replaces the worst chromosome. The
+ * islands receive from their predecessor in a ring or, with a random
+ * topology, from a random island. */
+class IslandGA {
+ protected:
+  vector<unique_ptr<GA>> islands;
+  int generations;
+  int migration_interval;
+  bool random_topology;
+  int generations_done = 0;
+
+  void migrate(int round);
+
+ public:
+  IslandGA(Chromossome *chr, int n_islands, int migration_interval,
+           bool random_topology, double mutation_rate, double crossover_rate,
+           int tournament_size, int population_size, int generations,
+           Timer timer);
+
+  void solve(Timer timer);
+  Fitness get_best_obj();
+  unique_ptr<Chromossome> get_best_chr();
+  int get_generations() const { return generations_done; }
+  int get_iterations() const;
+};
@@ -0,0 +1,72 @@
+#include "random_packing.hpp"
+
+#include <omp.h>
+
+#include <vector>
+
+#include "../misc/rng.hpp"
+
+/* Best decomposition found by one thread. */
+struct Candidate {
+  unique_ptr<CycleGraph> cg;
+  int obj;
+  int iteration = -1;
+
+  bool better_than(const Candidate &that) const {
+    return that.iteration == -1 || obj > that.obj ||
+           (obj == that.obj && iteration < that.iteration);
+  }
+};
+
+unique_ptr<CycleGraph> random_packing(const CycleGraph &cg, int iterations,
+                                      Timer &timer, int &performed) {
+  vector<Candidate> best(omp_get_max_threads());
+  int next = 0, count = 0;
+  iterations = max(iterations, 1);
+
+#pragma omp parallel reduction(+ : count)
+  {
+    Candidate &thread_best = best[omp_get_thread_num()];
+    Candidate current;
+    current.cg.reset(new CycleGraph(cg));
+    thread_best.cg.reset(new CycleGraph(cg));
+
+    auto sample = [&](int i) {
+      Rng rng = task_rng(i);
+      current.cg->reset();
+      current.cg->decompose_with_bfs(i != 0, rng);
+      current.obj = current.cg->dec_size() - current.cg->potation();
+      current.iteration = i;
+      if (current.better_than(thread_best)) {
+        /* Keep the old best to be reused by the next iteration. */
+        swap(current, thread_best);
+      }
+      count++;
+    };
+
+    if (timer.has_limit()) {
+      /* The first iteration always runs, so there is always a result. */
+      for (;;) {
+        int i;
+#pragma omp atomic capture
+        i = next++;
+        if (i > 0 && timer.done()) break;
+        sample(i);
+      }
+    } else {
+#pragma omp for schedule(static)
+      for (int i = 0; i < iterations; ++i) {
+        sample(i);
+      }
+    }
+  }
+
+  performed = count;
+  Candidate *result = &best[0];
+  for (auto &candidate : best) {
+    if (candidate.iteration != -1 && candidate.better_than(*result)) {
+      result = &candidate;
+    }
+  }
+  return move(result->cg);
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <memory>
+
+#include "../cycle/cycles.hpp"
+#include "../misc/timer.hpp"
+using namespace std;
+
+/* Random Packings heuristic: build the given number of decompositions of the
+ * graph with randomized bfs and return the one with most cycles (discounting
+ * the indel potation). The first iteration is not randomized. Iteration i
+ * uses its own random stream and ties are broken by the smallest iteration,
+ * so the result does not depend on the number of threads.
+ * If the timer has a time limit, decompositions are generated until the time
+ * runs out instead. The number of decompositions generated is stored in
+ * performed. */
+unique_ptr<CycleGraph> random_packing(const CycleGraph &cg, int iterations,
+                                      Timer &timer, int &performed);
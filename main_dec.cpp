@@ -1,4 +1,5 @@
 #include <getopt.h>
+#include <omp.h>
 
 #include <experimental/filesystem>
 #include <fstream>
@@ -7,25 +8,47 @@
 
 #include "cycle/cycles.hpp"
 #include "heur/ga.hpp"
+#include "heur/island_ga.hpp"
+#include "heur/random_packing.hpp"
 #include "misc/genome.hpp"
+#include "misc/instance_queue.hpp"
+#include "misc/binary_instances.hpp"
+#include "misc/generator.hpp"
 #include "misc/io.hpp"
+#include "misc/ordered_writer.hpp"
 #include "misc/reduction_rules.hpp"
+#include "misc/rng.hpp"
 #include "misc/timer.hpp"
 namespace fs = experimental::filesystem;
 using namespace std;
 
 #define N_POS_ARGS 1
+/* Under the auto schedule, instances with a smaller cost (genome sizes times
+ * iterations) are solved whole on a single thread, several at a time. */
+#define INTRA_INSTANCE_COST (1 << 22)
+/* Number of instances read ahead for each thread. */
+#define PREFETCH_PER_THREAD 4
 
 struct Args {
   string heuristic;
   string input_file;
   string output_folder;
   int iterations = 100;
+  double time_limit = 0;
   bool extend = false;
+  bool intergenic = false;
   int tournament_size = 2;
   int mutation_rate = 50;
   int crossover_rate = 50;
+  int islands = 1;
+  int migration = 10;
+  bool random_topology = false;
+  string schedule = "auto";
   bool fill_zero = false;
+  uint64_t seed = time(0);
+  GeneratorParams generator;
+  int instances = 1;
+  bool binary = false;
 };
 
 void help(char *name) {
@@ -33,30 +56,99 @@ void help(char *name) {
           "by the origin and target signed genomes."
        << endl
        << "\t" << name << " HEUR [OPTIONS]" << endl
+       << "\t" << name << " convert [-i INPUT] -o OUTPUT [-r]" << endl
+       << "\t" << name << " generate [-o OUTPUT] [-b] [-s SEED] [GENERATOR OPTIONS]"
+       << endl
        << endl
        << "positional arguments:" << endl
        << "\tHEUR                    the heuristic to use (ga|rand)" << endl
+       << "\tconvert                 convert the input to the binary format, "
+          "which dec and dist read without parsing, writing it to OUTPUT"
+       << endl
+       << "\tgenerate                simulate instances like the ones of db "
+          "(see db/README.md) and write them to OUTPUT (stdout if not "
+          "provided), in the text format of convert"
+       << endl
        << endl
        << "optional arguments:" << endl
        << "\t-h, --help              show this help message and exit" << endl
        << "\t-i, --input INPUT       input file (if not provided stdin is "
-          "used). Each 2 lines of the input file correspond to a instance, "
-          "each line has a list of space separated values, and represent in "
-          "order the origin string and the target string."
+          "used). Each 2 lines (4 with -r) of the input file correspond to a "
+          "instance, each line has a list of space separated values, and "
+          "represent in order the origin string and the target string. Files "
+          "created with convert are also accepted."
        << endl
        << "\t-o, --output OUTPUT     output folder (if not provided stdout is "
           "used)"
        << endl
        << "\t-k, --iterations ITER   number of iterations (default 100)"
        << endl
+       << "\t-l, --time-limit SECS   time limit for each instance, rand "
+          "samples decompositions until it expires and ga stops between "
+          "generations (default no limit)"
+       << endl
        << "\t-m, --mutation MUT      mutation rate in percentage for GA (default 50%)"
        << endl
        << "\t-c, --crossover CROS    crossover rate in percentage for GA (default 50%)"
        << endl
        << "\t-t, --tournament TOUR   number of elements in each tournament for GA (default 2)"
        << endl
+       << "\t-I, --islands ISL       number of islands for GA, the population "
+          "is divided among the islands (default 1)"
+       << endl
+       << "\t-M, --migration GEN     number of generations between "
+          "migrations of the best chromosomes among islands (default 10)"
+       << endl
+       << "\t-R, --random-topology   migrate between random islands instead "
+          "of along a ring"
+       << endl
+       << "\t-S, --schedule POLICY   how to split the threads among the "
+          "instances (auto|instance|iteration): instance solves several "
+          "instances at a time with a thread each, iteration solves one "
+          "instance at a time with every thread, auto chooses for each "
+          "instance based on its size and the number of iterations "
+          "(default auto)"
+       << endl
+       << "\t-r, --intergenic        each instance of a text input has 4 "
+          "lines, the intergenic regions follow the genes of each genome, "
+          "one less than the genes, or one more with -e (also for convert)"
+       << endl
        << "\t-e, --extend            whether to extend the genomes before "
           "apply the algorithm"
+       << endl
+       << "\t-s, --seed SEED         seed for the random generators (default "
+          "current time), runs with the same seed and number of threads "
+          "produce the same result"
+       << endl
+       << endl
+       << "generator options:" << endl
+       << "\t-n, --length N          genes of the origin, at least 2 "
+          "(default 100)"
+       << endl
+       << "\t-A, --alphabet N        labels of the origin are drawn from 1 "
+          "to N (default 100)"
+       << endl
+       << "\t-V, --reversals N       reversals applied to the origin "
+          "(default 0)"
+       << endl
+       << "\t-T, --transpositions N  transpositions applied to the origin, "
+          "in random order with the reversals (default 0)"
+       << endl
+       << "\t-D, --deletions N       deletions of a single gene applied "
+          "after them, keeping at least two genes (default a quarter of "
+          "the operations)"
+       << endl
+       << "\t-N, --insertions N      insertions of a single gene applied "
+          "last (default a quarter of the operations)"
+       << endl
+       << "\t-G, --ir-max SIZE       draw intergenic regions from 0 to SIZE, "
+          "each instance then has 4 lines, with one more intergenic region "
+          "than genes in each genome, which dec reads with -r -e "
+          "(default no intergenic regions)"
+       << endl
+       << "\t-C, --instances N       number of instances (default 1)" << endl
+       << "\t-b, --binary            write the binary format, OUTPUT is "
+          "required"
        << endl;
 
   exit(EXIT_SUCCESS);
@@ -70,15 +162,33 @@ void get_args(Args &args, int argc, char *argv[]) {
   struct option longopts[] = {{"input", 1, NULL, 'i'},
                               {"output", 1, NULL, 'o'},
                               {"iterations", 1, NULL, 'k'},
+                              {"time-limit", 1, NULL, 'l'},
                               {"mutation", 1, NULL, 'm'},
                               {"crossover", 1, NULL, 'c'},
                               {"tournament", 1, NULL, 't'},
+                              {"islands", 1, NULL, 'I'},
+                              {"migration", 1, NULL, 'M'},
+                              {"random-topology", 0, NULL, 'R'},
+                              {"schedule", 1, NULL, 'S'},
+                              {"intergenic", 0, NULL, 'r'},
                               {"extend", 0, NULL, 'e'},
+                              {"seed", 1, NULL, 's'},
                               {"help", 0, NULL, 'h'},
+                              {"length", 1, NULL, 'n'},
+                              {"alphabet", 1, NULL, 'A'},
+                              {"reversals", 1, NULL, 'V'},
+                              {"transpositions", 1, NULL, 'T'},
+                              {"deletions", 1, NULL, 'D'},
+                              {"insertions", 1, NULL, 'N'},
+                              {"ir-max", 1, NULL, 'G'},
+                              {"instances", 1, NULL, 'C'},
+                              {"binary", 0, NULL, 'b'},
+                              {0, 0, 0, 0},
   };
+  int deletions = -1, insertions = -1;
 
   char op;
-  while ((op = getopt_long(argc, argv, "i:o:k:m:c:t:heaz", longopts, NULL)) != -1) {
+  while ((op = getopt_long(argc, argv, "i:o:k:l:m:c:t:I:M:RS:s:rhen:A:V:T:D:N:G:C:b", longopts, NULL)) != -1) {
     switch (op) {
       case 'i':
         args.input_file = optarg;
@@ -89,6 +199,9 @@ void get_args(Args &args, int argc, char *argv[]) {
       case 'k':
         args.iterations = atoi(optarg);
         break;
+      case 'l':
+        args.time_limit = atof(optarg);
+        break;
       case 'm':
         args.mutation_rate = atoi(optarg);
         break;
@@ -98,9 +211,54 @@ void get_args(Args &args, int argc, char *argv[]) {
       case 't':
         args.tournament_size = atoi(optarg);
         break;
+      case 'I':
+        args.islands = atoi(optarg);
+        break;
+      case 'M':
+        args.migration = atoi(optarg);
+        break;
+      case 'R':
+        args.random_topology = true;
+        break;
+      case 'S':
+        args.schedule = optarg;
+        break;
+      case 'r':
+        args.intergenic = true;
+        break;
       case 'e':
         args.extend = true;
         break;
+      case 's':
+        args.seed = strtoull(optarg, NULL, 10);
+        break;
+      case 'n':
+        args.generator.length = atoi(optarg);
+        break;
+      case 'A':
+        args.generator.alphabet = atoi(optarg);
+        break;
+      case 'V':
+        args.generator.reversals = atoi(optarg);
+        break;
+      case 'T':
+        args.generator.transpositions = atoi(optarg);
+        break;
+      case 'D':
+        deletions = atoi(optarg);
+        break;
+      case 'N':
+        insertions = atoi(optarg);
+        break;
+      case 'G':
+        args.generator.ir_max = atoi(optarg);
+        break;
+      case 'C':
+        args.instances = atoi(optarg);
+        break;
+      case 'b':
+        args.binary = true;
+        break;
       default:
         help(argv[0]);
     }
@@ -113,104 +271,213 @@ void get_args(Args &args, int argc, char *argv[]) {
   if (n_pos_args != N_POS_ARGS) {
     help(argv[0]);
   }
+  if (args.heuristic != "rand" && args.heuristic != "ga" &&
+      args.heuristic != "convert" && args.heuristic != "generate") {
+    help(argv[0]);
+  }
+  /* As in db, a quarter of the operations of each kind of indel. */
+  int ops = args.generator.reversals + args.generator.transpositions;
+  args.generator.deletions = (deletions >= 0) ? deletions : ops / 4;
+  args.generator.insertions = (insertions >= 0) ? insertions : ops / 4;
+  if (args.heuristic == "generate" &&
+      (args.generator.length < 2 || args.generator.alphabet <= 0 ||
+       args.generator.reversals < 0 || args.generator.transpositions < 0 ||
+       args.instances < 0 || (args.binary && args.output_folder == ""))) {
+    help(argv[0]);
+  }
+  if (args.heuristic == "convert" && args.output_folder == "") {
+    help(argv[0]);
+  }
+  if (args.schedule != "auto" && args.schedule != "instance" &&
+      args.schedule != "iteration") {
+    help(argv[0]);
+  }
 }
 
-CycleGraph *get_best_cg(CycleGraph *cg1, CycleGraph *cg2) {
-        if (cg1->dec_size() - cg1->potation() >
-            cg2->dec_size() - cg2->potation()) {
-            delete cg2;
-            return cg1;
-        } else {
-            delete cg1;
-            return cg2;
-        }
-}
+/* Find a decomposition for one instance and write it to the output folder, or
+ * to out if there is none. */
+void solve_instance(const Args &args, InputData &data, int name_idx,
+                    ostream &out) {
+  Timer timer(args.time_limit);
+  int iterations = 0, generations = -1;
+  ofstream os;
+  unique_ptr<CycleGraph> cg, cg_best;
 
-int main(int argc, char *argv[]) {
-  Args args;
-  ifstream is;
-  unique_ptr<vector<string>> input_lines;
+  suboptimal_rule_interval(*data.g, *data.h);
+  suboptimal_rule_pairs(*data.g, *data.h);
+  cg = unique_ptr<CycleGraph>(new CycleGraph(*data.g, *data.h));
 
-  get_args(args, argc, argv);
+  if (args.heuristic == "rand") {
+    cg_best = random_packing(*cg, args.iterations, timer, iterations);
+  } else if (args.heuristic == "ga" && args.islands > 1) {
+    int start = args.iterations / 10;
+    int island_size = max(2, start / args.islands);
+    if (island_size % 2 == 1) {
+      island_size += 1;
+    }
+    IslandGA ga = IslandGA(
+        new Chromossome(*cg), args.islands, args.migration,
+        args.random_topology, args.mutation_rate / 100.0,
+        args.crossover_rate / 100.0, args.tournament_size, island_size,
+        (args.iterations - start) / (island_size * args.islands), timer);
+    ga.solve(timer);
+    cg_best = ga.get_best_chr();
+    iterations = ga.get_iterations();
+    generations = ga.get_generations();
+  } else {
+    ostream *ga_os = nullptr;
+    int start = args.iterations / 10;
+    if (start % 2 == 1) {
+      start += 1;
+    }
+    GA ga = GA(new Chromossome(*cg), args.mutation_rate / 100.0,
+            args.crossover_rate / 100.0, args.tournament_size, start, start,
+            (args.iterations - start) / start, ga_os, timer,
+            derive_seed(get_seed(), 0));
+    ga.solve(timer);
+    cg_best = ga.get_best_chr();
+    iterations = ga.get_iterations();
+    generations = ga.get_generations();
+  }
 
-  // set seed
-  /* srand(1); */
-  srand(time(0));
+  if (args.output_folder != "") {
+    os.open((args.output_folder / fs::path(args.input_file).filename())
+                .string() +
+            string(5 - to_string(name_idx).size(), '0') +
+            to_string(name_idx) + "-best");
+  }
 
-  if (args.input_file != "") {
-    is.open(args.input_file);
-    input_lines.reset(read_lines(is));
-    is.close();
-  } else {
-    input_lines.reset(read_lines(cin));
+  output((args.output_folder != "") ? os : out, *cg_best,
+         timer.elapsed_time(), iterations, generations);
+
+  if (args.output_folder != "") {
+    os.close();
+    os.open((args.output_folder / fs::path(args.input_file).filename())
+                .string() +
+            string(5 - to_string(name_idx).size(), '0') +
+            to_string(name_idx) + "-perm");
   }
 
-  int div = 2;
-  try {
-    if (input_lines->size() % div == 1) {
-      throw invalid_argument("Number of lines is not multiple of 2.");
-    }
+  output((args.output_folder != "") ? os : out, cg_best->get_perms());
+  /* cout << - cg_best->dec_size() + cg_best->potation() << endl; */
+}
 
-    for (size_t i = 0; i < input_lines->size(); i += div) {
-      Timer timer;
-      ofstream os;
-      unique_ptr<CycleGraph> cg, cg_aux, cg_best;
-      int name_idx = i / div;
+/* Write the instances made by the generator, each one from its own seed
+ * derived from the given one. */
+void generate(const Args &args) {
+  unique_ptr<BinaryInstancesWriter> writer;
+  ofstream os;
+  bool irs = args.generator.ir_max >= 0;
+  if (args.binary) {
+    writer.reset(new BinaryInstancesWriter(args.output_folder, irs));
+  } else if (args.output_folder != "") {
+    os.open(args.output_folder);
+    if (!os) {
+      throw invalid_argument("Could not create " + args.output_folder + ".");
+    }
+  }
+  ostream &out = (args.output_folder != "") ? os : cout;
 
-      InputData data;
-      data = input((*input_lines)[i], (*input_lines)[i + 1], args.extend);
-      suboptimal_rule_interval(*data.g, *data.h);
-      suboptimal_rule_pairs(*data.g, *data.h);
-      cg = unique_ptr<CycleGraph>(new CycleGraph(*data.g, *data.h));
-
-      if (args.heuristic == "rand") {
-        CycleGraph *cg_rand = new CycleGraph(*cg);
-        cg_rand->decompose_with_bfs(false);
-
-#pragma omp declare reduction(select_cg : CycleGraph* : omp_out = get_best_cg(omp_in, omp_out))
-#pragma omp parallel for reduction(                                            \
-        select_cg                                                                  \
-        : cg_rand) // Process each decomposition in parallel
-        for (int i = 1; i < args.iterations; ++i) {
-          cg_rand = new CycleGraph(*cg);
-          cg_rand->decompose_with_bfs(true);
-        }
-      } else if (args.heuristic == "ga") {
-        ostream *ga_os;
-        int start = args.iterations / 10;
-        if (start % 2 == 1) {
-          start += 1;
-        }
-        GA ga = GA(new Chromossome(*cg), args.mutation_rate / 100.0,
-                args.crossover_rate / 100.0, args.tournament_size, start, start,
-                (args.iterations - start) / start, ga_os, timer);
-        ga.solve(timer);
-        cg_best = ga.get_best_chr();
-      } else {
-        help(argv[0]);
+  for (int i = 0; i < args.instances; ++i) {
+    Rng rng(derive_seed(args.seed, i), 0);
+    GeneratedInstance inst = generate_instance(args.generator, rng);
+    if (writer) {
+      writer->write(inst.g, inst.g_irs, inst.h, inst.h_irs);
+      continue;
+    }
+    const vector<int> *lines[] = {&inst.g, &inst.g_irs, &inst.h, &inst.h_irs};
+    for (int k = 0; k < 4; ++k) {
+      if (!irs && k % 2 == 1) continue;
+      for (size_t t = 0; t < lines[k]->size(); ++t) {
+        if (t > 0) out << ' ';
+        out << (*lines[k])[t];
       }
+      out << '\n';
+    }
+  }
+  if (writer) writer->close();
+}
 
-      if (args.output_folder != "") {
-        os.close();
-        os.open((args.output_folder / fs::path(args.input_file).filename())
-                    .string() +
-                string(5 - to_string(name_idx).size(), '0') +
-                to_string(name_idx) + "-best");
-      }
+/* Whether the instance runs whole on a single thread, concurrently with
+ * other instances, instead of parallelizing the heuristic itself. */
+bool run_batched(const Args &args, const InputData &data, bool few_instances) {
+  if (args.schedule == "instance") {
+    return true;
+  } else if (args.schedule == "iteration") {
+    return false;
+  }
+  /* Not enough instances to keep every thread busy. */
+  if (few_instances) {
+    return false;
+  }
+  /* Under a time limit each instance takes the same time anyway. */
+  if (args.time_limit > 0) {
+    return true;
+  }
+  double cost = double(data.g->size() + data.h->size()) * args.iterations;
+  return cost < INTRA_INSTANCE_COST;
+}
 
-      output((args.output_folder != "") ? os : cout, *cg_best,
-             timer.elapsed_time());
+int main(int argc, char *argv[]) {
+  Args args;
+  OrderedWriter writer(cout);
 
-      if (args.output_folder != "") {
-        os.close();
-        os.open((args.output_folder / fs::path(args.input_file).filename())
-                    .string() +
-                string(5 - to_string(name_idx).size(), '0') +
-                to_string(name_idx) + "-perm");
+  get_args(args, argc, argv);
+
+  try {
+    if (args.heuristic == "convert") {
+      ifstream is;
+      if (args.input_file != "") {
+        is.open(args.input_file);
       }
+      convert_to_binary((args.input_file != "") ? is : cin,
+                        args.output_folder, args.intergenic);
+      return 0;
+    }
+    if (args.heuristic == "generate") {
+      generate(args);
+      return 0;
+    }
 
-      output((args.output_folder != "") ? os : cout, cg_best->get_perms());
-      /* cout << - cg_best->dec_size() + cg_best->potation() << endl; */
+    unique_ptr<InstanceSource> source =
+        open_instances(args.input_file, args.extend, args.intergenic);
+    /* The instances are read while the previous ones are solved, so the
+     * first outputs are written before the whole input is read. */
+    InstanceQueue queue(*source,
+                        PREFETCH_PER_THREAD * omp_get_max_threads());
+    bool few = !queue.has_at_least(omp_get_max_threads());
+    auto batched = [&args, few](const InputData &data) {
+      return run_batched(args, data, few);
+    };
+    auto whole = [&batched](const InputData &data) { return !batched(data); };
+
+    /* Consecutive instances with the same policy are solved together, the
+     * outputs are written in the input order as they become available. */
+    while (!queue.finished()) {
+      size_t idx;
+      InputData data;
+      if (queue.pop_if(whole, idx, data)) {
+        ostringstream os;
+        set_seed(derive_seed(args.seed, idx));
+        solve_instance(args, data, idx, os);
+        writer.write(idx, os.str());
+        continue;
+      }
+      /* Each thread takes the next instance as soon as it is done, until
+       * one that needs every thread comes. */
+#pragma omp parallel
+      {
+        size_t i;
+        InputData instance;
+        while (queue.pop_if(batched, i, instance)) {
+          ostringstream os;
+          set_thread_seed(derive_seed(args.seed, i));
+          solve_instance(args, instance, i, os);
+          clear_thread_seed();
+          instance = InputData();
+          writer.write(i, os.str());
+        }
+      }
     }
 
   } catch (const invalid_argument &e) {
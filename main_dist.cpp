@@ -1,18 +1,32 @@
 #include "distance_algorithms/r_or_rt_noir.hpp"
 #include "external/external.hpp"
+#include "external/plugin.hpp"
 #include "misc/genome.hpp"
+#include "misc/instance_queue.hpp"
 #include "misc/io.hpp"
+#include "misc/ordered_writer.hpp"
+#include "misc/parallel_error.hpp"
 #include "misc/permutation.hpp"
+#include "misc/rng.hpp"
 #include "misc/timer.hpp"
 #include <experimental/filesystem>
 #include <fstream>
 #include <getopt.h>
+#include <omp.h>
 #include <iostream>
 #include <sstream>
 namespace fs = experimental::filesystem;
 using namespace std;
 
 #define N_POS_ARGS 1
+/* Number of instances read ahead for each thread. */
+#define PREFETCH_PER_THREAD 4
+/* Number of mappings generated before the algorithms are called, so the
+ * algorithms that solve many permutations at once receive them together. */
+#define MAPPINGS_PER_BATCH 64
+/* Under the auto schedule, instances with a smaller cost (genome sizes times
+ * iterations) are solved whole on a single thread, several at a time. */
+#define INTRA_INSTANCE_COST (1 << 22)
 
 struct Args {
   string input_file;
@@ -21,33 +35,76 @@ struct Args {
   bool extend = false;
   bool duplicate = false;
   bool fill_zero = false;
-  string alg;
+  bool batch_runs = false;
+  bool persistent = false;
+  bool intergenic = false;
+  bool unordered = false;
+  uint64_t seed = time(0);
+  string schedule = "auto";
+  vector<string> algs;
+};
+
+/* Algorithm given in the command line, the ones that remove the indels with
+ * an IndelReducer also have reduced set, so the reduction of a mapping is
+ * shared by all of them. */
+struct AlgEntry {
+  string name;
+  unique_ptr<DistAlg> alg;
+  R_OR_RT_NOIR *reduced = nullptr;
 };
 
 void help(char *name) {
   cout << "usage: Calculate distances for pairs of strings. If replicas are "
        << "presents multiple random mappings are generated." << endl
-       << "\t" << name << " ALG [OPTIONS]" << endl
+       << "\t" << name << " ALG[,ALG...] [OPTIONS]" << endl
        << endl
        << "positional arguments:" << endl
-       << "\tALG      the algorithm to use, the options are:" << endl
+       << "\tALG      the algorithm to use, a comma separated list evaluates "
+          "every algorithm on the same mappings, the options are:" << endl
        << "\t\t - reversal: 2-approximation for sorting by reversals and indels in signed permutations" << endl
        << "\t\t - reversal_transposition: heuristic for sorting by reversals, transposition and indels in signed permutations" << endl
        << "\t\t - the name of an executable in the external folder"
        << endl
+       << "\t\t - the name of a shared library (.so) in the external folder "
+          "implementing the interface of external/dist_plugin.h"
+       << endl
        << endl
        << "optional arguments:" << endl
        << "\t-h, --help              show this help message and exit" << endl
        << "\t-i, --input INPUT       input file (if not provided stdin is "
-          "used). Each 2 lines of the input file correspond to a instance, "
-          "each line has a list of space separated values, and represent in "
-          "order the origin string and the target string."
+          "used). Each 2 lines (4 with -r) of the input file correspond to a "
+          "instance, each line has a list of space separated values, and "
+          "represent in order the origin string and the target string. Files "
+          "created with dec convert are also accepted."
        << endl
        << "\t-o, --output OUTPUT     output folder (if not provided stdout is used)"
        << endl
        << "\t-k, --iterations ITER   number of iterations (default 1)" << endl
+       << "\t-r, --intergenic        each instance of a text input has 4 "
+          "lines, the intergenic regions follow the genes of each genome, "
+          "one less than the genes, or one more with -e"
+       << endl
        << endl
        << "\t-e, --extend            whether to extend the genomes before apply the algorithm"
+       << endl
+       << "\t-s, --seed SEED         seed for the random mappings (default current time)"
+       << endl
+       << "\t-b, --batch-runs        insert the runs of all the cycles of a decomposition "
+          "at once (reversal and reversal_transposition only)"
+       << endl
+       << "\t-p, --persistent        keep one process of the external program "
+          "for each thread, sending one instance per line to its stdin"
+       << endl
+       << "\t-S, --schedule POLICY   how to split the threads among the "
+          "instances (auto|instance|iteration): instance solves several "
+          "instances at a time with a thread each, iteration solves one "
+          "instance at a time running its iterations in parallel, auto "
+          "chooses for each instance based on its size and the number of "
+          "iterations (default auto)"
+       << endl
+       << "\t-u, --unordered         write the results of each instance as "
+          "soon as it is solved, after a line with its index, instead of in "
+          "the input order"
        << endl;
 
   exit(EXIT_SUCCESS);
@@ -61,10 +118,13 @@ void get_args(Args &args, int argc, char *argv[]) {
   struct option longopts[] = {
       {"input", 1, NULL, 'i'},      {"output", 1, NULL, 'o'},
       {"iterations", 1, NULL, 'k'}, {"extend", 0, NULL, 'e'},
-      {"help", 0, NULL, 'h'}};
+      {"seed", 1, NULL, 's'},       {"help", 0, NULL, 'h'},
+      {"batch-runs", 0, NULL, 'b'}, {"persistent", 0, NULL, 'p'},
+      {"schedule", 1, NULL, 'S'},   {"unordered", 0, NULL, 'u'},
+      {"intergenic", 0, NULL, 'r'}, {0, 0, 0, 0}};
 
   char op;
-  while ((op = getopt_long(argc, argv, "i:o:k:he", longopts, NULL)) != -1) {
+  while ((op = getopt_long(argc, argv, "i:o:k:s:S:hebpur", longopts, NULL)) != -1) {
     switch (op) {
     case 'i':
       args.input_file = optarg;
@@ -78,102 +138,270 @@ void get_args(Args &args, int argc, char *argv[]) {
     case 'e':
       args.extend = true;
       break;
+    case 's':
+      args.seed = strtoull(optarg, NULL, 10);
+      break;
+    case 'b':
+      args.batch_runs = true;
+      break;
+    case 'p':
+      args.persistent = true;
+      break;
+    case 'S':
+      args.schedule = optarg;
+      break;
+    case 'u':
+      args.unordered = true;
+      break;
+    case 'r':
+      args.intergenic = true;
+      break;
     default:
       help(argv[0]);
     }
   }
   for (int i = optind; i < argc; i++) {
-    args.alg = argv[i];
+    stringstream ss(argv[i]);
+    string alg;
+    args.algs.clear();
+    while (getline(ss, alg, ',')) {
+      if (alg != "") args.algs.push_back(alg);
+    }
     n_pos_args++;
   }
 
-  if (n_pos_args != N_POS_ARGS) {
+  if (n_pos_args != N_POS_ARGS || args.algs.empty()) {
+    help(argv[0]);
+  }
+  if (args.schedule != "auto" && args.schedule != "instance" &&
+      args.schedule != "iteration") {
     help(argv[0]);
   }
 }
 
-int main(int argc, char *argv[]) {
-  Args args;
-  ifstream is;
-  unique_ptr<vector<string>> input_lines;
-  unique_ptr<DistAlg> alg;
-
-  get_args(args, argc, argv);
-
-  // set seed
-  // srand(1);
-  srand(time(0));
-
-  // set algorithm
-  if (args.alg == "reversal") {
-    alg.reset(new ReversalNOIR());
-  } else if (args.alg == "reversal_transposition") {
-    alg.reset(new ReversalTranspositionNOIR());
+AlgEntry make_alg(const string &name, const Args &args) {
+  AlgEntry entry;
+  entry.name = name;
+  if (name == "reversal") {
+    entry.reduced = new ReversalNOIR(args.batch_runs);
+    entry.alg.reset(entry.reduced);
+  } else if (name == "reversal_transposition") {
+    entry.reduced = new ReversalTranspositionNOIR(args.batch_runs);
+    entry.alg.reset(entry.reduced);
+  } else if (name.size() > 3 && name.substr(name.size() - 3) == ".so") {
+    entry.alg.reset(new PluginDistAlg("external/" + name));
   } else {
-    alg.reset(new ExternalDistAlg("external/" + args.alg));
+    entry.alg.reset(new ExternalDistAlg("external/" + name, args.persistent));
   }
+  return entry;
+}
 
-  unique_ptr<ReversalNOIR> alg_rnoir = unique_ptr<ReversalNOIR>(new ReversalNOIR());
-
-  if (args.input_file != "") {
-    is.open(args.input_file);
-    input_lines.reset(read_lines(is));
-    is.close();
+/* Output a distance, labeled with the algorithm if there are several. */
+void output_dist(ostream &os, const vector<AlgEntry> &algs, size_t a,
+                 int dist, double time) {
+  if (algs.size() == 1) {
+    output(os, dist, time);
   } else {
-    input_lines.reset(read_lines(cin));
+    output(os, algs[a].name, dist, time);
   }
+}
 
-  int div = 2;
-  try {
-    if (input_lines->size() % div == 1) {
-      throw invalid_argument("Number of lines is not multiple of 2.");
-    }
-#pragma omp parallel for
-    for (size_t i = 0; i < input_lines->size(); i += div) {
-      Timer timer;
-      ofstream os;
-      unique_ptr<Permutation> pi, pi_best;
-      int dist, dist_best = std::numeric_limits<int>::max();
+/* Solve an instance with every algorithm and write the results to the output
+ * folder, or to out. The iterations run in parallel if parallel is set. Each
+ * iteration has its own generator, so the results do not depend on how the
+ * iterations are scheduled. */
+void solve_instance(const Args &args, const vector<AlgEntry> &algs,
+                    const IndelReducer *reducer, InputData &data, size_t idx,
+                    bool parallel, ostream &out) {
+  Timer timer;
+  ofstream os;
+  vector<shared_ptr<Permutation>> pi_best(algs.size());
+  vector<int> dist_best(algs.size(), std::numeric_limits<int>::max());
 
-      InputData data;
-      data = input((*input_lines)[i], (*input_lines)[i + 1], args.extend);
+  if (args.output_folder != "") {
+    os.open((args.output_folder / fs::path(args.input_file).filename()).string() +
+            string(5 - to_string(idx).size(), '0') + to_string(idx) +
+            "-all");
+  }
 
-      if (args.output_folder != "") {
-        os.open((args.output_folder / fs::path(args.input_file).filename()).string() +
-                string(5 - to_string(i / div).size(), '0') + to_string(i / div) +
-                "-all");
+  for (int j = 1; j <= args.iterations; j += MAPPINGS_PER_BATCH) {
+    int n = min(MAPPINGS_PER_BATCH, args.iterations - j + 1);
+    vector<shared_ptr<Permutation>> pis(n);
+    vector<const Permutation *> batch(n);
+    vector<ReducedInstance> reduced(reducer ? n : 0);
+    /* The mappings and their reductions are computed once, and their time is
+     * added to the time of every algorithm that uses them. */
+    vector<double> map_time(n), reduce_time(n, 0);
+    ParallelError errors;
+#pragma omp parallel for schedule(dynamic, 1) if (parallel)
+    for (int i = 0; i < n; ++i) {
+      if (errors.failed()) continue;
+      try {
+        Timer it_timer;
+        Rng rng = task_rng(j + i);
+        pis[i].reset(new Permutation(*data.g, *data.h, args.duplicate, rng));
+        batch[i] = pis[i].get();
+        map_time[i] = it_timer.since_last_mark();
+        if (reducer) {
+          reduced[i] = reducer->reduce(*pis[i], rng);
+          reduce_time[i] = it_timer.since_last_mark() - map_time[i];
+        }
+      } catch (...) {
+        errors.capture();
       }
+    }
+    errors.rethrow();
 
-      for (int j = 1; j <= args.iterations; ++j) {
+    vector<vector<int>> dists(algs.size(), vector<int>(n));
+    vector<vector<double>> times(algs.size(), vector<double>(n));
+    for (size_t a = 0; a < algs.size(); ++a) {
+      if (algs[a].alg->batched()) {
+        /* The time of the batch is split among its mappings. */
         timer.mark_time();
-        pi.reset(new Permutation(*data.g, *data.h, args.duplicate));
-        cout << *pi << endl;
-        dist = alg->estimate_distance(*pi);
-        output((args.output_folder != "") ? os : cout, dist,
-               timer.since_last_mark());
-        if (dist < dist_best) {
-          dist_best = dist;
-          pi_best = move(pi);
+        algs[a].alg->estimate_distances(batch, dists[a]);
+        double time = timer.since_last_mark() / n;
+        for (int i = 0; i < n; ++i) {
+          times[a][i] = map_time[i] + time;
+        }
+        continue;
+      }
+#pragma omp parallel for schedule(dynamic, 1) if (parallel)
+      for (int i = 0; i < n; ++i) {
+        if (errors.failed()) continue;
+        try {
+          Timer it_timer;
+          dists[a][i] = algs[a].reduced
+                            ? algs[a].reduced->estimate_distance(reduced[i])
+                            : algs[a].alg->estimate_distance(*pis[i]);
+          times[a][i] = map_time[i] +
+                        (algs[a].reduced ? reduce_time[i] : 0) +
+                        it_timer.since_last_mark();
+        } catch (...) {
+          errors.capture();
         }
       }
+      errors.rethrow();
+    }
 
-      if (args.output_folder != "") {
-        os.close();
-        os.open((args.output_folder / fs::path(args.input_file).filename()).string() +
-                string(5 - to_string(i / div).size(), '0') + to_string(i / div) +
-                "-best");
+    /* The best mapping is the first one with the smallest distance, as if the
+     * iterations were run in order. */
+    for (int i = 0; i < n; ++i) {
+      out << *pis[i] << endl;
+      for (size_t a = 0; a < algs.size(); ++a) {
+        output_dist((args.output_folder != "") ? os : out, algs, a,
+                    dists[a][i], times[a][i]);
+        if (dists[a][i] < dist_best[a]) {
+          dist_best[a] = dists[a][i];
+          pi_best[a] = pis[i];
+        }
       }
+    }
+  }
+
+  if (args.output_folder != "") {
+    os.close();
+    os.open((args.output_folder / fs::path(args.input_file).filename()).string() +
+            string(5 - to_string(idx).size(), '0') + to_string(idx) +
+            "-best");
+  }
+
+  for (size_t a = 0; a < algs.size(); ++a) {
+    if (args.output_folder != "") {
+      os << *pi_best[a] << endl;
+      output_dist(os, algs, a, dist_best[a], timer.elapsed_time());
+    } else {
+      out << *pi_best[a] << endl;
+      output_dist(out, algs, a, dist_best[a], timer.elapsed_time());
+    }
+  }
+}
+
+/* Whether the instance runs whole on a single thread, concurrently with
+ * other instances, instead of parallelizing its iterations. */
+bool run_batched(const Args &args, const InputData &data, bool few_instances) {
+  if (args.schedule == "instance") {
+    return true;
+  } else if (args.schedule == "iteration") {
+    return false;
+  }
+  /* Not enough instances to keep every thread busy. */
+  if (few_instances) {
+    return false;
+  }
+  double cost = double(data.g->size() + data.h->size()) * args.iterations;
+  return cost < INTRA_INSTANCE_COST;
+}
+
+int main(int argc, char *argv[]) {
+  Args args;
+  vector<AlgEntry> algs;
+
+  get_args(args, argc, argv);
+  OrderedWriter writer(cout, !args.unordered);
 
-      if (args.output_folder != "") {
-        os << *pi_best << endl;
-        output(os, dist_best, timer.elapsed_time());
-      } else {
-        cout << *pi_best << endl;
-        output(cout, dist_best, timer.elapsed_time());
+  bool reduce = false;
+  IndelReducer reducer(args.batch_runs);
+
+  try {
+    // set algorithms
+    for (auto &name : args.algs) {
+      algs.push_back(make_alg(name, args));
+      if (algs.back().reduced) reduce = true;
+    }
+
+    unique_ptr<InstanceSource> source =
+        open_instances(args.input_file, args.extend, args.intergenic);
+    /* The instances are read while the previous ones are solved, only the
+     * ones being solved and a few read ahead are kept in memory. */
+    InstanceQueue queue(*source,
+                        PREFETCH_PER_THREAD * omp_get_max_threads());
+    bool few = !queue.has_at_least(omp_get_max_threads());
+    auto batched = [&args, few](const InputData &data) {
+      return run_batched(args, data, few);
+    };
+    auto whole = [&batched](const InputData &data) { return !batched(data); };
+
+    /* Consecutive instances with the same policy are solved together, the
+     * outputs are formatted by each thread and written by the writer. */
+    while (!queue.finished()) {
+      size_t idx;
+      InputData data;
+      if (queue.pop_if(whole, idx, data)) {
+        ostringstream os;
+        if (args.unordered) os << "Instance: " << idx << endl;
+        set_seed(derive_seed(args.seed, idx));
+        solve_instance(args, algs, reduce ? &reducer : nullptr, data, idx,
+                       true, os);
+        writer.write(idx, os.str());
+        continue;
+      }
+      /* Each thread takes the next instance as soon as it is done, until
+       * one that needs every thread comes. An error stops every thread and
+       * is reported after the region. */
+      ParallelError errors;
+#pragma omp parallel
+      {
+        size_t i;
+        InputData instance;
+        while (!errors.failed() && queue.pop_if(batched, i, instance)) {
+          ostringstream os;
+          if (args.unordered) os << "Instance: " << i << endl;
+          set_thread_seed(derive_seed(args.seed, i));
+          try {
+            solve_instance(args, algs, reduce ? &reducer : nullptr, instance,
+                           i, false, os);
+          } catch (...) {
+            errors.capture();
+          }
+          clear_thread_seed();
+          instance = InputData();
+          if (!errors.failed()) writer.write(i, os.str());
+        }
       }
+      errors.rethrow();
     }
 
-  } catch (const invalid_argument &e) {
+  } catch (const exception &e) {
     cerr << "Something went wrong!!!" << endl;
     cerr << e.what() << endl;
   }
@@ -0,0 +1,199 @@
+#include "binary_instances.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <stdexcept>
+
+#include "parser.hpp"
+
+/* "GENOMES1" in little endian */
+#define BINARY_MAGIC 0x3153454d4f4e4547ULL
+#define BINARY_VERSION 1
+
+static_assert(sizeof(int) == sizeof(int32_t), "genes are stored as int32");
+
+bool is_binary_instances(const string &file) {
+  ifstream is(file, ios::binary);
+  uint64_t magic = 0;
+  is.read((char *)&magic, sizeof(magic));
+  return is && magic == BINARY_MAGIC;
+}
+
+BinaryInstances::BinaryInstances(const string &file, bool extend)
+    : file(file), extend(extend) {
+  int fd = open(file.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw invalid_argument("Could not open " + file + ".");
+  }
+  struct stat st;
+  if (fstat(fd, &st) == 0 && size_t(st.st_size) >= sizeof(BinaryHeader)) {
+    length = st.st_size;
+    void *p = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    data = (p == MAP_FAILED) ? nullptr : (const char *)p;
+  }
+  close(fd);
+  if (data == nullptr) {
+    throw invalid_argument("Could not map " + file + ".");
+  }
+  /* Instances are read in order. */
+  madvise((void *)data, length, MADV_SEQUENTIAL);
+
+  header = (const BinaryHeader *)data;
+  index = (const uint64_t *)(data + header->index);
+  if (header->magic != BINARY_MAGIC || header->version != BINARY_VERSION ||
+      header->index % sizeof(uint64_t) != 0 || header->index > length ||
+      (length - header->index) / sizeof(uint64_t) < header->count) {
+    munmap((void *)data, length);
+    data = nullptr;
+    throw invalid_argument(file + " is not a valid instances file.");
+  }
+}
+
+invalid_argument BinaryInstances::malformed(size_t i) const {
+  return invalid_argument(file + " is not a valid instances file, instance " +
+                          to_string(i) + " is malformed.");
+}
+
+BinaryInstances::~BinaryInstances() {
+  if (data != nullptr) {
+    munmap((void *)data, length);
+    data = nullptr;
+  }
+}
+
+InputData BinaryInstances::get(size_t i) const {
+  uint64_t pos = index[i];
+  const int32_t *sizes = (const int32_t *)(data + pos);
+  if (pos % sizeof(int32_t) != 0 || pos > header->index ||
+      (header->index - pos) / sizeof(int32_t) < 4) {
+    throw malformed(i);
+  }
+  uint64_t total = 4;
+  for (int k = 0; k < 4; ++k) {
+    if (sizes[k] < 0) {
+      throw malformed(i);
+    }
+    total += sizes[k];
+  }
+  if ((header->index - pos) / sizeof(int32_t) < total) {
+    throw malformed(i);
+  }
+  /* Genome reads one intergenic region between each pair of adjacent genes,
+   * the caps included if the genomes are extended, or none. */
+  for (int k = 0; k < 4; k += 2) {
+    int n_irs = extend ? sizes[k] + 1 : sizes[k] - 1;
+    if (sizes[k] == 0) {
+      throw malformed(i);
+    }
+    if (sizes[k + 1] != 0 && sizes[k + 1] != n_irs) {
+      throw invalid_argument(
+          "Instance " + to_string(i) + " of " + file + " has " +
+          to_string(sizes[k + 1]) + " intergenic regions for " +
+          to_string(sizes[k]) + " genes, expected " + to_string(n_irs) +
+          (extend ? " (extended genomes)." : " (-e extends the genomes)."));
+    }
+  }
+
+  const int32_t *g = sizes + 4;
+  const int32_t *g_irs = g + sizes[0];
+  const int32_t *h = g_irs + sizes[1];
+  const int32_t *h_irs = h + sizes[2];
+  InputData instance;
+  instance.g.reset(new Genome(g, sizes[0], g_irs, sizes[1], extend));
+  instance.h.reset(new Genome(h, sizes[2], h_irs, sizes[3], extend));
+  return instance;
+}
+
+size_t BinaryInstances::next(vector<InputData> &batch, size_t max) {
+  batch.clear();
+  while (batch.size() < max && count < size()) {
+    batch.push_back(get(count++));
+  }
+  return batch.size();
+}
+
+BinaryInstancesWriter::BinaryInstancesWriter(const string &file, bool irs)
+    : os(file, ios::binary) {
+  if (!os) {
+    throw invalid_argument("Could not create " + file + ".");
+  }
+  header.magic = BINARY_MAGIC;
+  header.version = BINARY_VERSION;
+  header.flags = irs ? BINARY_HAS_IRS : 0;
+  header.count = 0;
+  header.index = 0;
+  /* The header is rewritten by close. */
+  os.write((const char *)&header, sizeof(header));
+}
+
+void BinaryInstancesWriter::write(const vector<int> &g,
+                                  const vector<int> &g_irs,
+                                  const vector<int> &h,
+                                  const vector<int> &h_irs) {
+  static const vector<int> none;
+  bool irs = header.flags & BINARY_HAS_IRS;
+  const vector<int> *arrays[] = {&g, irs ? &g_irs : &none, &h,
+                                 irs ? &h_irs : &none};
+
+  index.push_back(os.tellp());
+  for (auto array : arrays) {
+    int32_t n = array->size();
+    os.write((const char *)&n, sizeof(n));
+  }
+  for (auto array : arrays) {
+    os.write((const char *)array->data(), array->size() * sizeof(int32_t));
+  }
+}
+
+void BinaryInstancesWriter::close() {
+  uint64_t pos = os.tellp();
+  int32_t padding = 0;
+  if (pos % sizeof(uint64_t) != 0) {
+    os.write((const char *)&padding, sizeof(padding));
+    pos += sizeof(padding);
+  }
+  os.write((const char *)index.data(), index.size() * sizeof(uint64_t));
+
+  header.count = index.size();
+  header.index = pos;
+  os.seekp(0);
+  os.write((const char *)&header, sizeof(header));
+  os.close();
+}
+
+size_t convert_to_binary(istream &is, const string &file, bool irs) {
+  InstanceReader reader(is, irs ? 4 : 2);
+  BinaryInstancesWriter writer(file, irs);
+  vector<string> lines;
+  vector<vector<int>> arrays(4);
+
+  while (reader.next(lines)) {
+    for (size_t k = 0; k < lines.size(); ++k) {
+      /* Without intergenic regions the lines are the genes of the origin
+       * and of the target. */
+      vector<int> &array = arrays[irs ? k : 2 * k];
+      const char *begin = lines[k].data(), *end = begin + lines[k].size();
+      array.clear();
+      array.reserve(max_ints(begin, end));
+      try {
+        parse_ints(begin, end, [&array](int x) { array.push_back(x); });
+      } catch (const ParseError &e) {
+        throw invalid_argument("Instance " + to_string(reader.position() - 1) +
+                               ", " + e.at_line(k + 1).what());
+      }
+      if (array.empty() && (!irs || k % 2 == 0)) {
+        throw invalid_argument("Instance " + to_string(reader.position() - 1) +
+                               ", " +
+                               ParseError("genome without genes", k + 1, 1)
+                                   .what());
+      }
+    }
+    writer.write(arrays[0], arrays[1], arrays[2], arrays[3]);
+  }
+  writer.close();
+  return reader.position();
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "io.hpp"
+using namespace std;
+
+/* Binary file with a list of instances, meant to be memory mapped and read
+ * without parsing. Values are stored in the byte order of the machine, which
+ * is checked through the magic number:
+ *   header    BinaryHeader
+ *   instances for each instance, the int32 number of genes and of intergenic
+ *             regions of the origin and of the target, followed by the genes
+ *             and intergenic regions of the origin and then of the target.
+ *             Labels are the ones of the text format (0 for alpha genes).
+ *   index     uint64 position of each instance
+ * Positions are in bytes from the beginning of the file. */
+struct BinaryHeader {
+  uint64_t magic;
+  uint32_t version;
+  uint32_t flags;
+  uint64_t count;  // number of instances
+  uint64_t index;  // position of the index
+};
+
+/* The instances have intergenic regions. */
+#define BINARY_HAS_IRS 1
+
+/* Check whether a file is in the binary format. */
+bool is_binary_instances(const string &file);
+
+/* Instances of a binary file, mapped in memory. */
+class BinaryInstances : public InstanceSource {
+  string file;
+  const char *data = nullptr;
+  size_t length = 0;
+  const BinaryHeader *header;
+  const uint64_t *index;
+  bool extend;
+
+  /* Error for the i-th instance, like the ones of a malformed header. */
+  invalid_argument malformed(size_t i) const;
+
+ public:
+  /* Throws invalid_argument if the file can not be mapped or is malformed. */
+  BinaryInstances(const string &file, bool extend);
+  ~BinaryInstances();
+  BinaryInstances(const BinaryInstances &) = delete;
+  BinaryInstances &operator=(const BinaryInstances &) = delete;
+  /* Number of instances in the file. */
+  size_t size() const { return header->count; }
+  /* Build the i-th instance. Each genome has no intergenic regions, or one
+   * less than its genes, or one more if extend is set, as in the text
+   * format. */
+  InputData get(size_t i) const;
+  size_t next(vector<InputData> &batch, size_t max) override;
+};
+
+/* Write instances to a binary file. */
+class BinaryInstancesWriter {
+  ofstream os;
+  BinaryHeader header;
+  vector<uint64_t> index;
+
+ public:
+  /* Throws invalid_argument if the file can not be created. */
+  BinaryInstancesWriter(const string &file, bool irs);
+  /* Add an instance, the vectors of intergenic regions are ignored if the
+   * file has none. */
+  void write(const vector<int> &g, const vector<int> &g_irs,
+             const vector<int> &h, const vector<int> &h_irs);
+  /* Write the index and the header. */
+  void close();
+};
+
+/* Convert instances in the text format (two lines for each instance, or four
+ * if irs is set, with the intergenic regions after the genes of each genome)
+ * to a binary file. Returns the number of instances converted. */
+size_t convert_to_binary(istream &is, const string &file, bool irs);
@@ -4,5 +4,17 @@
 
 class DistAlg {
 public:
+    virtual ~DistAlg() {}
     virtual int estimate_distance(Permutation pi) = 0;
+    /* Distances of several permutations, algorithms that solve many
+     * permutations at once override it. */
+    virtual void estimate_distances(const vector<const Permutation *> &pis,
+                                    vector<int> &dists) {
+      dists.clear();
+      for (const Permutation *pi : pis) {
+        dists.push_back(estimate_distance(*pi));
+      }
+    }
+    /* Whether estimate_distances is faster than one call per permutation. */
+    virtual bool batched() const { return false; }
 };
@@ -0,0 +1,95 @@
+#include "generator.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+#include "genome_tree.hpp"
+
+static Gene random_gene(int alphabet, Rng &rng) {
+  Gene a = 1 + rng.below(alphabet);
+  return rng.below(2) ? a : -a;
+}
+
+static IR random_ir(int ir_max, Rng &rng) {
+  return (ir_max > 0) ? rng.below(ir_max + 1) : 0;
+}
+
+/* Random point of an intergenic region, the part to its left. */
+static IR cut(IR r, Rng &rng) { return (r > 0) ? rng.below(r + 1) : 0; }
+
+GeneratedInstance generate_instance(const GeneratorParams &params, Rng &rng) {
+  assert(params.length >= 2 && params.alphabet > 0);
+  GeneratedInstance inst;
+  bool irs = params.ir_max >= 0;
+  /* Genes 1 and n + 2 of the tree are caps, so every gene of the string has
+   * an intergenic region on each side. */
+  vector<Genea> genes(1, Genea(0, false));
+  vector<IR> regions;
+  for (int i = 0; i < params.length; ++i) {
+    genes.push_back(Genea(random_gene(params.alphabet, rng), false));
+    regions.push_back(random_ir(params.ir_max, rng));
+  }
+  genes.push_back(Genea(0, false));
+  regions.push_back(random_ir(params.ir_max, rng));
+  for (size_t i = 1; i + 1 < genes.size(); ++i) {
+    inst.g.push_back(genes[i].first);
+  }
+  if (irs) inst.g_irs = regions;
+
+  GenomeTree h(genes, regions);
+  /* true for a reversal, false for a transposition */
+  vector<bool> ops(params.reversals, true);
+  ops.resize(params.reversals + params.transpositions, false);
+  shuffle(ops.begin(), ops.end(), rng);
+  for (bool is_reversal : ops) {
+    int n = h.size() - 2;
+    if (is_reversal) {
+      int i = 2 + rng.below(n), j = 2 + rng.below(n);
+      if (i > j) swap(i, j);
+      IR x = h.ir(i - 1), y = h.ir(j);
+      IR x_left = cut(x, rng), y_left = cut(y, rng);
+      h.reverse(i, j, true);
+      h.set_ir(i - 1, x_left + y_left);
+      h.set_ir(j, (x - x_left) + (y - y_left));
+    } else if (n >= 2) {
+      /* Swap the blocks [i, j) and [j, k), none of them empty. */
+      int cuts[3];
+      do {
+        for (int &c : cuts) c = 2 + rng.below(n + 1);
+        sort(cuts, cuts + 3);
+      } while (cuts[0] == cuts[1] || cuts[1] == cuts[2]);
+      int i = cuts[0], j = cuts[1], k = cuts[2];
+      IR x = h.ir(i - 1), y = h.ir(j - 1), z = h.ir(k - 1);
+      IR x_left = cut(x, rng), y_left = cut(y, rng), z_left = cut(z, rng);
+      h.swap_blocks(i, j, k);
+      h.set_ir(i - 1, x_left + (y - y_left));
+      h.set_ir(i + k - j - 1, z_left + (x - x_left));
+      h.set_ir(k - 1, y_left + (z - z_left));
+    }
+  }
+  /* Keep at least two genes, the ends of a genome that is not extended are
+   * its caps, and an empty genome would be an empty line in the text format,
+   * which the readers skip. */
+  for (int t = 0; t < params.deletions && h.size() > 4; ++t) {
+    int i = 2 + rng.below(h.size() - 2);
+    IR joined = h.ir(i - 1) + h.ir(i);
+    h.erase(i, i + 1);
+    h.set_ir(i - 1, joined);
+  }
+  for (int t = 0; t < params.insertions; ++t) {
+    /* The new gene goes after the gene i, splitting the region after it. */
+    int i = 1 + rng.below(h.size() - 1);
+    IR r = h.ir(i), left = cut(r, rng);
+    vector<Genea> gene(1, Genea(random_gene(params.alphabet, rng), false));
+    vector<IR> region(1, left);
+    h.set_ir(i, r - left);
+    h.insert(i, gene, region);
+  }
+
+  h.flatten(genes, regions);
+  for (size_t i = 1; i + 1 < genes.size(); ++i) {
+    inst.h.push_back(genes[i].first);
+  }
+  if (irs) inst.h_irs = regions;
+  return inst;
+}
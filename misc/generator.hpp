@@ -0,0 +1,38 @@
+#pragma once
+
+#include <vector>
+
+#include "genome.hpp"
+#include "rng.hpp"
+using namespace std;
+
+/* Parameters of a simulated instance, the process is the one used to build
+ * the db/ corpus (see db/README.md). */
+struct GeneratorParams {
+  int length = 100;   // number of genes of the origin, at least 2
+  int alphabet = 100; // labels are drawn from 1 to alphabet
+  int reversals = 0;
+  int transpositions = 0;
+  int deletions = 0;  // of a single gene each, at most length - 2
+  int insertions = 0; // of a single gene each
+  int ir_max = -1;    // intergenic regions are drawn from 0 to ir_max, none
+                      // if negative
+};
+
+/* Pair of strings without the caps, as written in the input files. The
+ * intergenic regions (one more than the genes, the first one before the
+ * first gene) are empty if the parameters have none. */
+struct GeneratedInstance {
+  vector<Gene> g;
+  vector<IR> g_irs;
+  vector<Gene> h;
+  vector<IR> h_irs;
+};
+
+/* Draw the origin uniformly from the alphabet, with random signs, and apply
+ * the reversals and transpositions in random order to obtain the target,
+ * followed by the deletions and then the insertions. Each operation splits
+ * the intergenic regions it cuts at a random point and joins the pieces
+ * that become adjacent, so their total size is kept. The target is kept in
+ * a GenomeTree, so each operation takes O(log n). */
+GeneratedInstance generate_instance(const GeneratorParams &params, Rng &rng);
@@ -1,27 +1,74 @@
 #include "genome.hpp"
+#include "genome_tree.hpp"
+#include "parser.hpp"
 
 #include <algorithm>
 #include <cassert>
 #include <cstring>
 #include <iostream>
-#include <sstream>
 #include <numeric>
+#include <typeinfo>
 #include <unordered_map>
 
-Genome::Genome(string str_g, bool extend) : Genome(str_g, "", extend) {}
-Genome::Genome(string str_g, string str_i, bool extend) : empty_vec() {
-  string token;
-  op_max = 1;
+Genome::Genome(const string &str_g, bool extend) : Genome(str_g, "", extend) {}
+Genome::Genome(const string &str_g, const string &str_i, bool extend)
+    : Genome(str_g.data(), str_g.data() + str_g.size(), str_i.data(),
+             str_i.data() + str_i.size(), extend) {}
+Genome::Genome(const char *g_begin, const char *g_end, const char *i_begin,
+               const char *i_end, bool extend)
+    : empty_vec() {
   genes.reset(new vector<Genea>());
   intergenic_regions.reset(new vector<IR>());
 
   /* Read each element of the string. */
+  genes->reserve(max_ints(g_begin, g_end) + 2);
+  if (extend) genes->push_back(Genea(0,false));
+  try {
+    parse_ints(g_begin, g_end,
+               [this](int a) { genes->push_back(Genea(a, false)); });
+  } catch (const ParseError &e) {
+    throw e.at_line(1);
+  }
+  if (genes->size() == (extend ? 1u : 0u)) {
+    throw ParseError("genome without genes", 1, 1);
+  }
+
+  /* Read each intergenic regions. */
+  intergenic_regions->reserve(max_ints(i_begin, i_end));
+  try {
+    parse_ints(i_begin, i_end,
+               [this](IR r) { intergenic_regions->push_back(r); });
+  } catch (const ParseError &e) {
+    throw e.at_line(2);
+  }
+  /* One intergenic region between each pair of adjacent genes, the caps
+   * included if the genome is extended. */
+  size_t n_irs = extend ? genes->size() : genes->size() - 1;
+  if (!intergenic_regions->empty() && intergenic_regions->size() != n_irs) {
+    throw ParseError("expected " + to_string(n_irs) + " intergenic regions",
+                     2, 1);
+  }
+
+  setup(extend);
+}
+
+Genome::Genome(const int *gs, size_t n_genes, const int *irs, size_t n_irs,
+               bool extend)
+    : empty_vec() {
+  genes.reset(new vector<Genea>());
+  intergenic_regions.reset(new vector<IR>(irs, irs + n_irs));
+  genes->reserve(n_genes + 2);
   if (extend) genes->push_back(Genea(0,false));
-  stringstream ssg(str_g);
-  while (getline(ssg, token, ' ')) {
-    Genea a = Genea(stoi(token), false);
-    genes->push_back(a);
-    if (abs(genes->back().first) > op_max) op_max = abs(genes->back().first);
+  for (size_t i = 0; i < n_genes; ++i) {
+    genes->push_back(Genea(gs[i], false));
+  }
+  setup(extend);
+}
+
+void Genome::setup(bool extend) {
+  op_max = 1;
+  for (Genea a : *genes) {
+    if (abs(a.first) > op_max) op_max = abs(a.first);
   }
   for (int i = 1; i < int(genes->size()); i++) {
     Genea a = (*genes)[i];
@@ -41,17 +88,8 @@ Genome::Genome(string str_g, string str_i, bool extend) : empty_vec() {
   }
   op_max += 2;
 
-  /* Read each intergenic regions. */
-  if (str_i == "") {
-      for (int i = 0; i < int(genes->size()) - 1; i++) {
-        intergenic_regions->push_back(0);
-      }
-  } else {
-      stringstream ssi(str_i);
-      while (getline(ssi, token, ' ')) {
-        IR r = stoi(token);
-        intergenic_regions->push_back(r);
-      }
+  if (intergenic_regions->empty()) {
+      intergenic_regions->resize(genes->size() - 1, 0);
   }
 
   record_positions();
@@ -72,6 +110,10 @@ Genome::Genome(const vector<Genea> gs, const vector<IR> irs) : empty_vec() {
 }
 
 Genome::Genome(const Genome &g) {
+  /* The vectors of a stale genome are copied as they are, they are rebuilt
+   * from the copy of the tree. */
+  if (g.tree) tree.reset(new GenomeTree(*g.tree));
+  stale = g.stale;
   genes = unique_ptr<vector<Genea>>(new vector<Genea>(*g.genes));
   intergenic_regions =
       unique_ptr<vector<IR>>(new vector<IR>(*g.intergenic_regions));
@@ -80,6 +122,29 @@ Genome::Genome(const Genome &g) {
   op_max = g.op_max;
 }
 
+Genome::Genome() {}
+Genome::~Genome() {}
+
+void Genome::use_tree(bool on) {
+  assert(typeid(*this) == typeid(Genome));
+  sync();
+  tree.reset(on ? new GenomeTree(*genes, *intergenic_regions) : nullptr);
+}
+
+void Genome::sync() const {
+  if (!stale) return;
+  tree->flatten(*genes, *intergenic_regions);
+  positions->assign(op_max + 1, vector<Gene>());
+  for (size_t i = 0; i < genes->size(); ++i) {
+    (*positions)[abs((*genes)[i].first)].push_back(i + 1);
+  }
+  stale = false;
+}
+
+Genea Genome::tree_gene(int i) const { return tree->gene(i); }
+IR Genome::tree_ir(int i) const { return tree->ir(i); }
+size_t Genome::tree_size() const { return tree->size(); }
+
 void Genome::record_positions() {
   /* Record list of positions for each label. */
   positions.reset(new vector<vector<Gene>>(op_max + 1));
@@ -93,6 +158,7 @@ int Genome::occ(Gene label) const {
 }
 
 int Genome::occ_max() const {
+  sync();
   vector<int> count(this->positions->size(), 0);
   for (size_t i = 1; i <= this->size(); ++i) {
     count[abs((*this)[i])]++;
@@ -100,7 +166,26 @@ int Genome::occ_max() const {
   return *max_element(count.begin(), count.end());
 }
 
+template <class F> void Genome::update_positions(int from, int to, F f) {
+  /* Find the labels before updating, so each one is updated once. */
+  vector<Gene> labels;
+  for (int p = from; p <= to; ++p) {
+    Gene label = abs((*genes)[p - 1].first);
+    vector<int> &pos_vec = (*positions)[label];
+    if (*lower_bound(pos_vec.begin(), pos_vec.end(), from) == p) {
+      labels.push_back(label);
+    }
+  }
+  for (Gene label : labels) {
+    vector<int> &pos_vec = (*positions)[label];
+    auto first = lower_bound(pos_vec.begin(), pos_vec.end(), from);
+    auto last = upper_bound(first, pos_vec.end(), to);
+    f(pos_vec, first, last);
+  }
+}
+
 const vector<int> &Genome::pos(Gene label) const {
+  sync();
   if (abs(label) >= positions->size()) return empty_vec;
   return (*positions)[abs(label)];
 }
@@ -119,18 +204,47 @@ void Genome::insertion(int i, vector<Gene> &new_genes_, vector<IR> &new_irs) {
     if (abs(a) >= op_max) op_max = abs(a) + 1;
     new_genes.push_back(Genea(a, false));
   }
-  
+  if (tree) {
+    tree->insert(i, new_genes, new_irs);
+    stale = true;
+    return;
+  }
+  if (int(positions->size()) <= op_max) positions->resize(op_max + 1);
+
+  int n = new_genes.size();
+  update_positions(i + 1, size(), [n](vector<int> &, vector<int>::iterator first,
+                                      vector<int>::iterator last) {
+    for (; first != last; ++first) *first += n;
+  });
   genes->insert(genes->begin() + i, new_genes.begin(), new_genes.end());
   intergenic_regions->insert(intergenic_regions->begin() + i - 1, new_irs.begin(), new_irs.end());
-  record_positions();
+  for (int t = i + 1; t <= i + n; ++t) {
+    vector<int> &pos_vec = (*positions)[abs((*genes)[t - 1].first)];
+    pos_vec.insert(upper_bound(pos_vec.begin(), pos_vec.end(), t), t);
+  }
 }
 
 void Genome::deletion(int i, int j, IR x) {
   assert(2 <= i);
   assert(i < j);
   assert(j <= int(size()));
-  assert(0 <= x &&
-         x <= (*intergenic_regions)[i - 2] + (*intergenic_regions)[j - 2]);
+  assert(0 <= x && x <= get_ir(i - 1) + get_ir(j - 1));
+
+  if (tree) {
+    tree->erase(i, j);
+    tree->set_ir(i - 1, x);
+    stale = true;
+    return;
+  }
+
+  /* Positions in [i, j) are removed, the following ones are shifted. */
+  update_positions(i, size(), [i, j](vector<int> &pos_vec,
+                                     vector<int>::iterator first,
+                                     vector<int>::iterator last) {
+    auto kept = lower_bound(first, last, j);
+    for (auto it = kept; it != last; ++it) *it -= j - i;
+    pos_vec.erase(first, kept);
+  });
 
   int k = i - 1, l = j - 1;
   (*intergenic_regions)[i - 2] = x;
@@ -141,19 +255,31 @@ void Genome::deletion(int i, int j, IR x) {
   (*genes)[k] = (*genes)[l];
   genes->resize(k + 1);
   intergenic_regions->resize(k);
-  record_positions();
 }
 
 void Genome::reversal(int i, int j, IR x, IR y) {
   assert(2 <= i);
   assert(i <= j);
   assert(j <= int(size()));
-  assert(0 <= x && x <= (*intergenic_regions)[i - 2]);
-  assert(0 <= y && y <= (*intergenic_regions)[j - 1]);
-
-  int x_rest = (*intergenic_regions)[i - 2] - x;
-  int y_rest = (*intergenic_regions)[j - 1] - y;
+  assert(0 <= x && x <= get_ir(i - 1));
+  assert(0 <= y && y <= get_ir(j));
+
+  int x_rest = get_ir(i - 1) - x;
+  int y_rest = get_ir(j) - y;
+
+  if (tree) {
+    tree->reverse(i, j);
+    tree->set_ir(i - 1, x + y);
+    tree->set_ir(j, x_rest + y_rest);
+    stale = true;
+    return;
+  }
 
+  update_positions(i, j, [i, j](vector<int> &, vector<int>::iterator first,
+                                vector<int>::iterator last) {
+    for (auto it = first; it != last; ++it) *it = i + j - *it;
+    reverse(first, last);
+  });
   for (int k = 0; k < (j - i + 1) / 2; k++) {
     swap((*genes)[i + k - 1], (*genes)[j - k - 1]);
     swap((*intergenic_regions)[i + k - 1], (*intergenic_regions)[j - k - 2]);
@@ -161,7 +287,6 @@ void Genome::reversal(int i, int j, IR x, IR y) {
 
   (*intergenic_regions)[i - 2] = x + y;
   (*intergenic_regions)[j - 1] = x_rest + y_rest;
-  record_positions();
 }
 
 void Genome::transposition(int i, int j, int k, IR x, IR y, IR z) {
@@ -169,13 +294,32 @@ void Genome::transposition(int i, int j, int k, IR x, IR y, IR z) {
   assert(i < j);
   assert(j < k);
   assert(k <= int(size()));
-  assert(0 <= x && x <= (*intergenic_regions)[i - 2]);
-  assert(0 <= y && y <= (*intergenic_regions)[j - 2]);
-  assert(0 <= z && z <= (*intergenic_regions)[k - 2]);
+  assert(0 <= x && x <= get_ir(i - 1));
+  assert(0 <= y && y <= get_ir(j - 1));
+  assert(0 <= z && z <= get_ir(k - 1));
+
+  int x_rest = get_ir(i - 1) - x;
+  int y_rest = get_ir(j - 1) - y;
+  int z_rest = get_ir(k - 1) - z;
+
+  if (tree) {
+    tree->swap_blocks(i, j, k);
+    tree->set_ir(i - 1, x + y_rest);
+    tree->set_ir(i + k - j - 1, z + x_rest);
+    tree->set_ir(k - 1, y + z_rest);
+    stale = true;
+    return;
+  }
 
-  int x_rest = (*intergenic_regions)[i - 2] - x;
-  int y_rest = (*intergenic_regions)[j - 2] - y;
-  int z_rest = (*intergenic_regions)[k - 2] - z;
+  /* Positions in [i, j) and [j, k) swap places. */
+  update_positions(i, k - 1, [i, j, k](vector<int> &,
+                                       vector<int>::iterator first,
+                                       vector<int>::iterator last) {
+    auto mid = lower_bound(first, last, j);
+    for (auto it = first; it != mid; ++it) *it += k - j;
+    for (auto it = mid; it != last; ++it) *it -= j - i;
+    rotate(first, mid, last);
+  });
 
   vector<Genea> aux1;
   vector<IR> aux2;
@@ -198,12 +342,13 @@ void Genome::transposition(int i, int j, int k, IR x, IR y, IR z) {
   (*intergenic_regions)[i - 2] = x + y_rest;
   (*intergenic_regions)[i + k - j - 2] = z + x_rest;
   (*intergenic_regions)[k - 2] = y + z_rest;
-  record_positions();
 }
 
 void Genome::replace_label(int idx, Gene label) {
+  sync();
   Genea old = (*genes)[idx-1];
   (*genes)[idx-1] = Genea((old.first < 0) ? -label : label, old.second);
+  if (tree) tree->set_gene(idx, (*genes)[idx-1]);
 
   vector<int> &pos_vec = (*positions)[abs(old.first)];
 
@@ -215,6 +360,7 @@ void Genome::replace_label(int idx, Gene label) {
 }
 
 void Genome::serialize(ostream &os) const {
+  sync();
   for (size_t i = 1; i <= size() - 1; ++i) {
     os << "(" << (*this)[i] << ((check_alpha(i)) ? "*" : "") << ") - " << get_ir(i) << " - ";
   }
@@ -227,6 +373,7 @@ ostream &operator<<(ostream &os, const Genome &g) {
 }
 
 void Genome::alphabet(unordered_map<int,int> &alf, bool negative) const {
+  sync();
   for (Genea a : *(this->genes)) {
     if (negative) {
       alf[abs(a.first)]--;
@@ -237,6 +384,8 @@ void Genome::alphabet(unordered_map<int,int> &alf, bool negative) const {
 }
 
 bool Genome::balanced(Genome &h) const {
+  sync();
+  h.sync();
   unordered_map<int,int> alf;
   this->alphabet(alf, false);
   h.alphabet(alf, true);
@@ -250,6 +399,7 @@ bool Genome::balanced(Genome &h) const {
 }
 
 int *Genome::get_perm() const {
+  sync();
   int *perm = new int[size()];
   for (int i = 0; i < int(genes->size()); i++) {
     perm[i] = (*genes)[i].first;
@@ -11,6 +11,8 @@ typedef int Gene;
 typedef pair<Gene,bool> Genea; // Gene with an indicator whether it is alpha or not (alpha genes must be deleted/inserted)
 typedef int IR;
 
+class GenomeTree;
+
 /* String representing a unichromossomal and linear genome (first gane has index 1) */
 class Genome {
 protected:
@@ -19,21 +21,61 @@ protected:
   unique_ptr<vector<vector<Gene>>> positions;
   vector<Gene> empty_vec;
   Gene op_max;
-  Genome(){};
+  /* If set, the edit operations are applied to the tree and the vectors
+   * above are stale until they are read again (see sync). */
+  unique_ptr<GenomeTree> tree;
+  mutable bool stale = false;
+  Genome();
   void record_positions();
+  Genea tree_gene(int i) const;
+  IR tree_ir(int i) const;
+  size_t tree_size() const;
+  /* Call f(positions of label, first, last) for each label with a gene in
+   * the positions [from, to], where [first, last) are its positions in that
+   * range. Used to update the positions in place when genes move. */
+  template <class F> void update_positions(int from, int to, F f);
+  /* Map the labels read from the input to the internal ones. */
+  void setup(bool extend);
 
 public:
-  Genome(string str_g, bool extend);
-  Genome(string str_g, string str_i, bool extend);
+  Genome(const string &str_g, bool extend);
+  Genome(const string &str_g, const string &str_i, bool extend);
+  /* Parse the genes in [g_begin, g_end) and the intergenic regions in
+   * [i_begin, i_end), which may be empty. Throws ParseError with line 1 for
+   * errors in the genes and 2 in the intergenic regions. */
+  Genome(const char *g_begin, const char *g_end, const char *i_begin,
+         const char *i_end, bool extend);
+  /* Genes and intergenic regions with the labels of the text format, the
+   * intergenic regions may be empty. */
+  Genome(const int *gs, size_t n_genes, const int *irs, size_t n_irs,
+         bool extend);
   Genome(vector<Genea> gs, vector<IR> irs);
   Genome(const Genome &g);
-  size_t size() const { return genes->size(); }
+  ~Genome();
+  /* Keep the genes in a balanced tree (see GenomeTree), where reversals,
+   * transpositions, insertions and deletions take O(log n) instead of O(n),
+   * for long genomes. After a sequence of edits, size, operator[], get_ir
+   * and check_alpha read the tree in O(log n), the other queries rebuild the
+   * vectors first (see sync), so they are best done between sequences of
+   * edits. A stale genome must not be read by several threads at once. Only
+   * plain genomes can use it, subclasses read the vectors directly. */
+  void use_tree(bool on = true);
+  /* Rebuild the vectors and positions from the tree after edits, in O(n).
+   * Called by the queries that read the vectors. */
+  void sync() const;
+  size_t size() const { return stale ? tree_size() : genes->size(); }
   /* Only read access to the elements. */
-  Gene operator[](int i) const { return (*genes)[i - 1].first; }
+  Gene operator[](int i) const {
+    return stale ? tree_gene(i).first : (*genes)[i - 1].first;
+  }
   /* Only read access to intergenic regions. */
-  IR get_ir(int i) const { return (*intergenic_regions)[i - 1]; }
+  IR get_ir(int i) const {
+    return stale ? tree_ir(i) : (*intergenic_regions)[i - 1];
+  }
   /* Check if the gene in position i is alpha (must be deleted) */
-  IR check_alpha(int i) const { return (*genes)[i - 1].second; }
+  IR check_alpha(int i) const {
+    return stale ? tree_gene(i).second : (*genes)[i - 1].second;
+  }
   /* Get maximum occurrence of a label */
   int occ(Gene label) const;
   /* Get maximum occurrence */
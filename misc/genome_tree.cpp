@@ -0,0 +1,229 @@
+#include "genome_tree.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+/* Elements of the sequence holding gene i and intergenic region i. */
+static inline int gene_elem(int i) { return 2 * i - 2; }
+static inline int ir_elem(int i) { return 2 * i - 1; }
+
+GenomeTree::GenomeTree(const vector<Genea> &genes, const vector<IR> &irs)
+    : nodes(1), rng(0, 0) {
+  assert(irs.size() + 1 == genes.size());
+  nodes[0] = Node{0, false, false, false, false, 0, 0, 0, 0};
+  vector<int> values;
+  vector<bool> alpha;
+  values.reserve(2 * genes.size());
+  alpha.reserve(2 * genes.size());
+  for (size_t i = 0; i < genes.size(); ++i) {
+    if (i > 0) {
+      values.push_back(irs[i - 1]);
+      alpha.push_back(false);
+    }
+    values.push_back(genes[i].first);
+    alpha.push_back(genes[i].second);
+  }
+  root = build(values, alpha, false);
+}
+
+int GenomeTree::new_node(int value, bool alpha, bool ir) {
+  Node node{value, alpha, ir, false, false, rng(), 0, 0, 1};
+  if (!free_nodes.empty()) {
+    int t = free_nodes.back();
+    free_nodes.pop_back();
+    nodes[t] = node;
+    return t;
+  }
+  nodes.push_back(node);
+  return nodes.size() - 1;
+}
+
+void GenomeTree::release(int t) {
+  if (t == 0) return;
+  release(nodes[t].left);
+  release(nodes[t].right);
+  free_nodes.push_back(t);
+}
+
+void GenomeTree::push(int t) {
+  Node &node = nodes[t];
+  if (node.reversed) {
+    swap(node.left, node.right);
+    if (node.left) nodes[node.left].reversed ^= true;
+    if (node.right) nodes[node.right].reversed ^= true;
+    node.reversed = false;
+  }
+  if (node.negated) {
+    if (!node.ir) node.value = -node.value;
+    if (node.left) nodes[node.left].negated ^= true;
+    if (node.right) nodes[node.right].negated ^= true;
+    node.negated = false;
+  }
+}
+
+void GenomeTree::update(int t) {
+  nodes[t].size = nodes[nodes[t].left].size + nodes[nodes[t].right].size + 1;
+}
+
+void GenomeTree::split(int t, int k, int &a, int &b) {
+  if (t == 0) {
+    a = b = 0;
+    return;
+  }
+  push(t);
+  if (nodes[nodes[t].left].size < k) {
+    split(nodes[t].right, k - nodes[nodes[t].left].size - 1, nodes[t].right, b);
+    a = t;
+  } else {
+    split(nodes[t].left, k, a, nodes[t].left);
+    b = t;
+  }
+  update(t);
+}
+
+int GenomeTree::merge(int a, int b) {
+  if (a == 0 || b == 0) return a ? a : b;
+  if (nodes[a].priority > nodes[b].priority) {
+    push(a);
+    nodes[a].right = merge(nodes[a].right, b);
+    update(a);
+    return a;
+  }
+  push(b);
+  nodes[b].left = merge(a, nodes[b].left);
+  update(b);
+  return b;
+}
+
+int GenomeTree::build(const vector<int> &values, const vector<bool> &alpha,
+                      bool first_ir) {
+  /* Cartesian tree of the elements in linear time, the right spine of the
+   * tree built so far is kept in a stack. */
+  vector<int> spine;
+  for (size_t k = 0; k < values.size(); ++k) {
+    int t = new_node(values[k], alpha[k], (k % 2 == 0) == first_ir);
+    int last = 0;
+    while (!spine.empty() && nodes[spine.back()].priority < nodes[t].priority) {
+      last = spine.back();
+      spine.pop_back();
+      update(last);
+    }
+    nodes[t].left = last;
+    if (!spine.empty()) nodes[spine.back()].right = t;
+    spine.push_back(t);
+  }
+  int r = spine.empty() ? 0 : spine.front();
+  while (!spine.empty()) {
+    update(spine.back());
+    spine.pop_back();
+  }
+  return r;
+}
+
+int GenomeTree::find(int k, bool &negated) const {
+  assert(0 <= k && k < nodes[root].size);
+  int t = root;
+  bool flip = false;
+  negated = false;
+  for (;;) {
+    /* Pending reversals of the ancestors swap the children. */
+    flip ^= nodes[t].reversed;
+    negated ^= nodes[t].negated;
+    int l = flip ? nodes[t].right : nodes[t].left;
+    int r = flip ? nodes[t].left : nodes[t].right;
+    if (k < nodes[l].size) {
+      t = l;
+    } else if (k == nodes[l].size) {
+      return t;
+    } else {
+      k -= nodes[l].size + 1;
+      t = r;
+    }
+  }
+}
+
+void GenomeTree::collect(int t, bool flip, bool negated,
+                         vector<pair<int, bool>> &order) const {
+  if (t == 0) return;
+  flip ^= nodes[t].reversed;
+  negated ^= nodes[t].negated;
+  collect(flip ? nodes[t].right : nodes[t].left, flip, negated, order);
+  order.push_back(make_pair(t, negated));
+  collect(flip ? nodes[t].left : nodes[t].right, flip, negated, order);
+}
+
+Genea GenomeTree::gene(int i) const {
+  bool negated;
+  const Node &node = nodes[find(gene_elem(i), negated)];
+  return Genea(negated ? -node.value : node.value, node.alpha);
+}
+
+IR GenomeTree::ir(int i) const { return nodes[find(ir_elem(i))].value; }
+
+void GenomeTree::set_gene(int i, Genea a) {
+  bool negated;
+  Node &node = nodes[find(gene_elem(i), negated)];
+  node.value = negated ? -a.first : a.first;
+  node.alpha = a.second;
+}
+
+void GenomeTree::set_ir(int i, IR r) { nodes[find(ir_elem(i))].value = r; }
+
+void GenomeTree::reverse(int i, int j, bool negate) {
+  int a, b, c;
+  split(root, gene_elem(i), a, b);
+  split(b, gene_elem(j) - gene_elem(i) + 1, b, c);
+  nodes[b].reversed ^= true;
+  nodes[b].negated ^= negate;
+  root = merge(a, merge(b, c));
+}
+
+void GenomeTree::swap_blocks(int i, int j, int k) {
+  int pre, fst, mid, snd, post;
+  split(root, gene_elem(i), pre, post);
+  split(post, gene_elem(j) - 1 - gene_elem(i), fst, post);
+  split(post, 1, mid, post);
+  split(post, gene_elem(k) - 1 - gene_elem(j), snd, post);
+  root = merge(pre, merge(snd, merge(mid, merge(fst, post))));
+}
+
+void GenomeTree::insert(int i, const vector<Genea> &genes,
+                        const vector<IR> &irs) {
+  assert(genes.size() == irs.size());
+  vector<int> values;
+  vector<bool> alpha;
+  for (size_t t = 0; t < genes.size(); ++t) {
+    values.push_back(irs[t]);
+    alpha.push_back(false);
+    values.push_back(genes[t].first);
+    alpha.push_back(genes[t].second);
+  }
+  int a, b;
+  split(root, gene_elem(i) + 1, a, b);
+  root = merge(a, merge(build(values, alpha, true), b));
+}
+
+void GenomeTree::erase(int i, int j) {
+  int a, b, c;
+  split(root, gene_elem(i), a, b);
+  split(b, 2 * (j - i), b, c);
+  release(b);
+  root = merge(a, c);
+}
+
+void GenomeTree::flatten(vector<Genea> &genes, vector<IR> &irs) const {
+  vector<pair<int, bool>> order;
+  order.reserve(nodes[root].size);
+  collect(root, false, false, order);
+  genes.clear();
+  irs.clear();
+  for (size_t k = 0; k < order.size(); ++k) {
+    const Node &node = nodes[order[k].first];
+    if (k % 2 == 0) {
+      int value = order[k].second ? -node.value : node.value;
+      genes.push_back(Genea(value, node.alpha));
+    } else {
+      irs.push_back(node.value);
+    }
+  }
+}
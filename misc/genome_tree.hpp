@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "genome.hpp"
+#include "rng.hpp"
+using namespace std;
+
+/* Genes of a genome interleaved with its intergenic regions (gene 1, ir 1,
+ * gene 2, ..., gene n) in an implicit treap with lazy reversal, so reversing,
+ * moving, inserting and removing a range of genes takes O(log n), as does
+ * accessing a gene or an intergenic region. Genes have index 1 to size(). */
+class GenomeTree {
+  struct Node {
+    int value;  // label of a gene or size of an intergenic region
+    bool alpha;
+    bool ir;        // the element is an intergenic region
+    bool reversed;  // children must be swapped and reversed
+    bool negated;   // genes of the subtree (this one included) must be negated
+    uint64_t priority;
+    int left, right;
+    int size;
+  };
+  /* Node 0 is the empty tree. */
+  vector<Node> nodes;
+  vector<int> free_nodes;
+  int root = 0;
+  Rng rng;
+
+  int new_node(int value, bool alpha, bool ir);
+  void push(int t);
+  void update(int t);
+  void split(int t, int k, int &a, int &b);
+  int merge(int a, int b);
+  /* The elements alternate between genes and intergenic regions, starting
+   * with a gene unless first_ir is set. */
+  int build(const vector<int> &values, const vector<bool> &alpha,
+            bool first_ir);
+  /* Node of the element k (starting at 0) of the sequence, and whether its
+   * gene has a pending negation. */
+  int find(int k, bool &negated) const;
+  int find(int k) const {
+    bool negated;
+    return find(k, negated);
+  }
+  /* Nodes of the subtree in the order of the sequence, each with whether its
+   * gene has a pending negation. */
+  void collect(int t, bool flip, bool negated,
+               vector<pair<int, bool>> &order) const;
+  void release(int t);
+
+ public:
+  GenomeTree(const vector<Genea> &genes, const vector<IR> &irs);
+  size_t size() const { return (nodes[root].size + 1) / 2; }
+  Genea gene(int i) const;
+  IR ir(int i) const;
+  void set_gene(int i, Genea a);
+  void set_ir(int i, IR r);
+  /* Reverse the genes [i, j] and the intergenic regions between them, and
+   * negate the signs of the genes if negate is set. */
+  void reverse(int i, int j, bool negate = false);
+  /* Swap the blocks of genes [i, j) and [j, k), the intergenic regions
+   * inside each block move with it and the one between them stays. */
+  void swap_blocks(int i, int j, int k);
+  /* Insert genes after gene i, each one preceded by an intergenic region. */
+  void insert(int i, const vector<Genea> &genes, const vector<IR> &irs);
+  /* Remove the genes [i, j) and the intergenic region after each one. */
+  void erase(int i, int j);
+  /* Copy the genes and intergenic regions to vectors. */
+  void flatten(vector<Genea> &genes, vector<IR> &irs) const;
+};
@@ -0,0 +1,74 @@
+#include "instance_queue.hpp"
+
+InstanceQueue::InstanceQueue(InstanceSource &source, size_t capacity)
+    : source(source), capacity(max(capacity, size_t(1))) {
+  reader = thread(&InstanceQueue::read_instances, this);
+}
+
+InstanceQueue::~InstanceQueue() {
+  {
+    lock_guard<mutex> guard(lock);
+    stopping = true;
+  }
+  changed.notify_all();
+  reader.join();
+}
+
+void InstanceQueue::read_instances() {
+  vector<InputData> batch;
+  for (;;) {
+    {
+      unique_lock<mutex> guard(lock);
+      changed.wait(guard, [this] { return stopping || items.size() < capacity; });
+      if (stopping) break;
+    }
+    size_t n = 0;
+    try {
+      n = source.next(batch, 1);
+    } catch (...) {
+      lock_guard<mutex> guard(lock);
+      error = current_exception();
+    }
+    lock_guard<mutex> guard(lock);
+    if (n == 0) break;
+    items.push_back(make_pair(read++, move(batch[0])));
+    changed.notify_all();
+  }
+  lock_guard<mutex> guard(lock);
+  ended = true;
+  changed.notify_all();
+}
+
+bool InstanceQueue::has_at_least(size_t n) {
+  unique_lock<mutex> guard(lock);
+  changed.wait(guard, [this, n] { return ended || read >= n; });
+  return read >= n;
+}
+
+bool InstanceQueue::pop_if(const function<bool(const InputData &)> &pred,
+                           size_t &idx, InputData &data) {
+  unique_lock<mutex> guard(lock);
+  changed.wait(guard, [this] { return ended || !items.empty(); });
+  if (items.empty() || !pred(items.front().second)) {
+    return false;
+  }
+  idx = items.front().first;
+  data = move(items.front().second);
+  items.pop_front();
+  changed.notify_all();
+  return true;
+}
+
+bool InstanceQueue::finished() {
+  unique_lock<mutex> guard(lock);
+  changed.wait(guard, [this] { return ended || !items.empty(); });
+  if (!items.empty()) {
+    return false;
+  }
+  if (error) {
+    exception_ptr e = error;
+    error = nullptr;
+    rethrow_exception(e);
+  }
+  return true;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "io.hpp"
+using namespace std;
+
+/* Instances of a source read ahead by a reader thread while they are being
+ * solved. At most capacity instances wait in the queue, so the memory used
+ * does not depend on the size of the input. Safe to use from several
+ * threads. */
+class InstanceQueue {
+  InstanceSource &source;
+  size_t capacity;
+  deque<pair<size_t, InputData>> items;  // index and instance
+  size_t read = 0;  // number of instances read so far
+  bool ended = false;
+  bool stopping = false;
+  exception_ptr error;
+  mutex lock;
+  condition_variable changed;
+  thread reader;
+
+  void read_instances();
+
+ public:
+  InstanceQueue(InstanceSource &source, size_t capacity);
+  /* Stop reading and wait for the reader. */
+  ~InstanceQueue();
+  InstanceQueue(const InstanceQueue &) = delete;
+  InstanceQueue &operator=(const InstanceQueue &) = delete;
+  /* Wait until n instances were read or the input ended, and return whether
+   * the input has at least n instances. */
+  bool has_at_least(size_t n);
+  /* Wait for the next instance and remove it if it satisfies pred. Returns
+   * false, leaving the queue as it is, if it does not or if there are no
+   * more instances. */
+  bool pop_if(const function<bool(const InputData &)> &pred, size_t &idx,
+              InputData &data);
+  /* Wait for the next instance and return whether there are no more. If
+   * reading failed the error is thrown once the instances read before it
+   * are removed. */
+  bool finished();
+};
@@ -1,19 +1,74 @@
 #include "io.hpp"
 #include "genome.hpp"
+#include "parser.hpp"
+#include "binary_instances.hpp"
 #include "../cycle/cycles.hpp"
+#include <fstream>
 #include <iostream>
 #include <sstream>
 
-vector<string> *read_lines(istream &is) {
-  auto input_lines = new vector<string>();
+bool InstanceReader::next(vector<string> &lines) {
+  lines.clear();
+  for (string line;
+       lines.size() < lines_per_instance && getline(is, line);) {
+    if (!line.empty() && line[0] != '#') {
+      lines.push_back(move(line));
+    }
+  }
+
+  if (lines.empty()) {
+    return false;
+  }
+  if (lines.size() < lines_per_instance) {
+    throw invalid_argument("Number of lines is not multiple of " +
+                           to_string(lines_per_instance) + ".");
+  }
+  count++;
+  return true;
+}
 
-  for (string line; getline(is, line);) {
-    if (line.at(0) != '#') {
-      input_lines->push_back(line);
+size_t InstanceReader::next(vector<vector<string>> &batch, size_t max) {
+  vector<string> lines;
+  batch.clear();
+  while (batch.size() < max && next(lines)) {
+    batch.push_back(move(lines));
+  }
+  return batch.size();
+}
+
+size_t TextInstances::next(vector<InputData> &batch, size_t max) {
+  vector<vector<string>> lines;
+  reader.next(lines, max);
+  batch.clear();
+  batch.resize(lines.size());
+  for (size_t k = 0; k < lines.size(); ++k) {
+    try {
+      batch[k] = irs ? input(lines[k][0], lines[k][1], lines[k][2],
+                             lines[k][3], extend)
+                     : input(lines[k][0], lines[k][1], extend);
+    } catch (const ParseError &e) {
+      throw invalid_argument("Instance " + to_string(count + k) + ", " +
+                             e.what());
     }
   }
+  count += batch.size();
+  return batch.size();
+}
 
-  return input_lines;
+unique_ptr<InstanceSource> open_instances(const string &file, bool extend,
+                                          bool irs) {
+  if (file == "") {
+    return unique_ptr<InstanceSource>(new TextInstances(cin, extend, irs));
+  }
+  if (is_binary_instances(file)) {
+    return unique_ptr<InstanceSource>(new BinaryInstances(file, extend));
+  }
+  unique_ptr<istream> is(new ifstream(file));
+  if (!*is) {
+    throw invalid_argument("Could not open " + file + ".");
+  }
+  return unique_ptr<InstanceSource>(
+      new TextInstances(move(is), extend, irs));
 }
 
 InputData input(string &line1, string &line2, bool extend) {
@@ -21,7 +76,11 @@ InputData input(string &line1, string &line2, bool extend) {
   InputData data;
 
   data.g = unique_ptr<Genome>(new Genome(line1, extend));
-  data.h = unique_ptr<Genome>(new Genome(line2, extend));
+  try {
+    data.h = unique_ptr<Genome>(new Genome(line2, extend));
+  } catch (const ParseError &e) {
+    throw e.at_line(2);
+  }
 
   return data;
 }
@@ -31,7 +90,11 @@ InputData input(string &line1, string &line2, string &line3, string &line4, bool
   InputData data;
 
   data.g = unique_ptr<Genome>(new Genome(line1, line2, extend));
-  data.h = unique_ptr<Genome>(new Genome(line3, line4, extend));
+  try {
+    data.h = unique_ptr<Genome>(new Genome(line3, line4, extend));
+  } catch (const ParseError &e) {
+    throw e.at_line(e.line + 2);
+  }
   /* if (data.g->size() != data.h->size()) { */
     /* throw invalid_argument("Size of genomes differ"); */
   /* } */
@@ -46,6 +109,11 @@ void output(ostream &os, int dist, double time) {
   os << ", Wall Time: " << time << "s" << endl;
 }
 
+void output(ostream &os, const string &alg, int dist, double time) {
+  os << "Alg: " << alg << ", ";
+  output(os, dist, time);
+}
+
 void output(ostream &os, const CycleGraph &cyc_dec, double time) {
   os << "Dec: " << cyc_dec;
   os.precision(5);
@@ -53,6 +121,19 @@ void output(ostream &os, const CycleGraph &cyc_dec, double time) {
   os << ", Wall Time: " << time << "s" << endl;
 }
 
+void output(ostream &os, const CycleGraph &cyc_dec, double time,
+            int iterations, int generations) {
+  os << "Dec: " << cyc_dec;
+  os << ", Objective: " << cyc_dec.dec_size() - cyc_dec.potation();
+  os << ", Iterations: " << iterations;
+  if (generations >= 0) {
+    os << ", Generations: " << generations;
+  }
+  os.precision(5);
+  os << fixed;
+  os << ", Wall Time: " << time << "s" << endl;
+}
+
 void output(ostream &os, InputData &data) {
     for (int i = 1; i <= int(data.g->size()); i++) {
             os << (*data.g)[i] << " ";
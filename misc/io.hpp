@@ -15,10 +15,75 @@ struct InputData {
   unique_ptr<Genome> h;
 };
 
-vector<string> *read_lines(istream &is);
+/* Read the instances of a stream one at a time, so only the instances being
+ * solved are kept in memory. Each instance has the given number of lines,
+ * empty lines and lines starting with # are ignored. */
+class InstanceReader {
+  istream &is;
+  size_t lines_per_instance;
+  size_t count = 0;
+
+ public:
+  InstanceReader(istream &is, size_t lines_per_instance)
+      : is(is), lines_per_instance(lines_per_instance) {}
+  /* Read the lines of the next instance, return false at the end of the
+   * input. Throws invalid_argument if the last instance is incomplete. */
+  bool next(vector<string> &lines);
+  /* Read the next instances, at most max of them, and return how many were
+   * read. */
+  size_t next(vector<vector<string>> &batch, size_t max);
+  /* Index of the next instance to be read. */
+  size_t position() const { return count; }
+};
+
+/* Instances of an input, read in batches. */
+class InstanceSource {
+ protected:
+  size_t count = 0;
+
+ public:
+  virtual ~InstanceSource() {}
+  /* Read the next instances, at most max of them, and return how many were
+   * read. Throws invalid_argument if the input is malformed. */
+  virtual size_t next(vector<InputData> &batch, size_t max) = 0;
+  /* Index of the next instance to be read. */
+  size_t position() const { return count; }
+};
+
+/* Instances in the text format, two lines for each one, or four if irs is
+ * set, with the intergenic regions after the genes of each genome. */
+class TextInstances : public InstanceSource {
+  unique_ptr<istream> owned;
+  InstanceReader reader;
+  bool extend;
+  bool irs;
+
+ public:
+  TextInstances(istream &is, bool extend, bool irs = false)
+      : reader(is, irs ? 4 : 2), extend(extend), irs(irs) {}
+  TextInstances(unique_ptr<istream> is, bool extend, bool irs = false)
+      : owned(move(is)), reader(*owned, irs ? 4 : 2), extend(extend),
+        irs(irs) {}
+  size_t next(vector<InputData> &batch, size_t max) override;
+};
+
+/* Open the instances of a file, in the text or in the binary format, or of
+ * stdin (text only) if the file name is empty. irs is the layout of the text
+ * format, binary files record whether they have intergenic regions. */
+unique_ptr<InstanceSource> open_instances(const string &file, bool extend,
+                                          bool irs = false);
+
+/* Parse an instance, throws ParseError with the line of the instance where
+ * the error is. */
 InputData input(string &line1, string &line2, bool extend);
 InputData input(string &line1, string &line2, string &line3, string &line4, bool extend);
 void output(ostream &os, int dist, double time);
+/* Output a distance labeled with the algorithm that computed it. */
+void output(ostream &os, const string &alg, int dist, double time);
 void output(ostream &os, const CycleGraph &, double time);
+/* Output a decomposition with the number of iterations (and generations, if
+ * not negative) used to find it. */
+void output(ostream &os, const CycleGraph &, double time, int iterations,
+            int generations = -1);
 void output(ostream &os, InputData &data);
 void output(ostream &os, PermsIrs);
@@ -0,0 +1,17 @@
+#include "ordered_writer.hpp"
+
+void OrderedWriter::write(size_t idx, string text) {
+  lock_guard<mutex> guard(lock);
+  if (!ordered) {
+    os << text;
+    os.flush();
+    return;
+  }
+  pending[idx] = move(text);
+  for (auto it = pending.begin(); it != pending.end() && it->first == next;
+       it = pending.erase(it)) {
+    os << it->second;
+    next++;
+  }
+  os.flush();
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+using namespace std;
+
+/* Write the outputs of tasks that finish in any order in the order of their
+ * indices (starting at 0). Each output is written as soon as the outputs of
+ * all previous tasks have been written. If ordered is not set the outputs are
+ * written as soon as they are ready, but never interleaved. Safe to use from
+ * several threads. */
+class OrderedWriter {
+  ostream &os;
+  bool ordered;
+  size_t next = 0;
+  map<size_t, string> pending;
+  mutex lock;
+
+ public:
+  OrderedWriter(ostream &os, bool ordered = true)
+      : os(os), ordered(ordered) {}
+  void write(size_t idx, string text);
+};
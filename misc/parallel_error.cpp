@@ -0,0 +1,13 @@
+#include "parallel_error.hpp"
+
+void ParallelError::capture() {
+  lock_guard<mutex> guard(lock);
+  if (!error) {
+    error = current_exception();
+    set = true;
+  }
+}
+
+void ParallelError::rethrow() {
+  if (error) rethrow_exception(error);
+}
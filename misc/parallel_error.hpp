@@ -0,0 +1,23 @@
+#pragma once
+
+#include <atomic>
+#include <exception>
+#include <mutex>
+using namespace std;
+
+/* First exception thrown by the threads of a parallel region. Exceptions
+ * must not leave an OpenMP region, so each thread calls capture in its catch
+ * block, the threads stop taking work once failed is set, and rethrow is
+ * called after the region. Safe to use from several threads. */
+class ParallelError {
+  exception_ptr error;
+  atomic<bool> set{false};
+  mutex lock;
+
+ public:
+  /* Keep the exception being handled, if it is the first one. */
+  void capture();
+  bool failed() const { return set; }
+  /* Throw the captured exception, if there is one. */
+  void rethrow();
+};
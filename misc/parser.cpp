@@ -0,0 +1,19 @@
+#include "parser.hpp"
+
+static string describe(const string &msg, size_t line, size_t column) {
+  string where = "column " + to_string(column) + ": ";
+  if (line > 0) {
+    where = "line " + to_string(line) + ", " + where;
+  }
+  return where + msg;
+}
+
+ParseError::ParseError(const string &msg, size_t line, size_t column)
+    : invalid_argument(describe(msg, line, column)),
+      line(line),
+      column(column),
+      msg(msg) {}
+
+ParseError ParseError::at_line(size_t line) const {
+  return ParseError(msg, line, column);
+}
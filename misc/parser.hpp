@@ -0,0 +1,64 @@
+#pragma once
+
+#include <climits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+using namespace std;
+
+/* Malformed text input. Lines and columns start at 1, line is 0 if it is not
+ * known. */
+class ParseError : public invalid_argument {
+ public:
+  size_t line, column;
+  ParseError(const string &msg, size_t line, size_t column);
+  /* The same error in the given line. */
+  ParseError at_line(size_t line) const;
+
+ private:
+  string msg;
+};
+
+/* Parse the whitespace separated signed integers in [begin, end) calling
+ * emit with each one, in a single pass and without copying the tokens.
+ * Throws ParseError if a token is not an integer or does not fit in an int. */
+template <class F>
+void parse_ints(const char *begin, const char *end, F emit) {
+  const char *p = begin;
+  while (p != end) {
+    if (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n') {
+      p++;
+      continue;
+    }
+    const char *token = p;
+    bool negative = (*p == '-');
+    if (*p == '-' || *p == '+') p++;
+    long long value = 0;
+    bool overflow = false;
+    const char *digits = p;
+    for (; p != end && '0' <= *p && *p <= '9'; p++) {
+      if (!overflow) {
+        value = value * 10 + (*p - '0');
+        overflow = value > (long long)INT_MAX + 1;
+      }
+    }
+    if (p == digits || (p != end && *p != ' ' && *p != '\t' && *p != '\r' &&
+                        *p != '\n')) {
+      while (p != end && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n')
+        p++;
+      throw ParseError("invalid integer '" + string(token, p) + "'", 0,
+                       token - begin + 1);
+    }
+    if (negative) value = -value;
+    if (overflow || value < INT_MIN || value > INT_MAX) {
+      throw ParseError("integer out of range '" + string(token, p) + "'", 0,
+                       token - begin + 1);
+    }
+    emit(int(value));
+  }
+}
+
+/* Upper bound on the number of integers in [begin, end), to reserve space. */
+inline size_t max_ints(const char *begin, const char *end) {
+  return (end - begin + 1) / 2;
+}
@@ -19,7 +19,8 @@ Permutation::Permutation(const Permutation &pi) {
       unique_ptr<vector<IR>>(new vector<IR>(*pi.intergenic_regions_target));
 }
 
-Permutation::Permutation(const Genome &g, const Genome &h, bool duplicate) {
+Permutation::Permutation(const Genome &g, const Genome &h, bool duplicate,
+                         Rng &rng) {
 
   if (duplicate) {
     genes.reset(new vector<Genea>(2 * g.size() - 2));
@@ -76,7 +77,7 @@ Permutation::Permutation(const Genome &g, const Genome &h, bool duplicate) {
   // }
 
   for (auto &l : labels) {
-    random_shuffle(l.second.begin(), l.second.end());
+    shuffle(l.second.begin(), l.second.end(), rng);
   }
 
   /* Add genes mapping replicas */
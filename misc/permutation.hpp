@@ -1,6 +1,7 @@
 #pragma once
 #include "../misc/io.hpp"
 #include "genome.hpp"
+#include "rng.hpp"
 using namespace std;
 
 class Permutation : public Genome {
@@ -14,7 +15,10 @@ class Permutation : public Genome {
   /* Copy constructor */
   Permutation(const Permutation &pi);
   /* Construct a permutation replicas are mapped randomly */
-  Permutation(const Genome &s, const Genome &h, bool duplicate);
+  Permutation(const Genome &s, const Genome &h, bool duplicate,
+              Rng &rng = thread_rng());
+  /* The breakpoints read the vectors, which the tree leaves stale. */
+  void use_tree(bool on = true) = delete;
   /* Separate iota from the permutation */
   InputData split_iota() const;
   /* Verify if the permutation is sorted and with the correct intergenic region
@@ -0,0 +1,103 @@
+#include "rng.hpp"
+
+#include <atomic>
+#include <cassert>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+using namespace std;
+
+static atomic<uint64_t> global_seed(0);
+static atomic<unsigned> seed_generation(0);
+/* Streams of the thread generators, disjoint from the task streams. */
+static const uint64_t THREAD_STREAMS = 1ULL << 63;
+/* Seed of the calling thread, overrides the global one while set. */
+static thread_local bool has_thread_seed = false;
+static thread_local uint64_t thread_seed = 0;
+static thread_local unsigned thread_seed_generation = 0;
+
+static uint64_t splitmix64(uint64_t &x) {
+  uint64_t z = (x += 0x9e3779b97f4a7c15ULL);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+static inline uint64_t rotl(uint64_t x, int k) {
+  return (x << k) | (x >> (64 - k));
+}
+
+Rng::Rng(uint64_t seed, uint64_t stream) {
+  uint64_t x = stream;
+  x = seed ^ splitmix64(x);
+  for (int i = 0; i < 4; ++i) {
+    s[i] = splitmix64(x);
+  }
+}
+
+Rng::result_type Rng::operator()() {
+  uint64_t result = rotl(s[1] * 5, 7) * 9;
+  uint64_t t = s[1] << 17;
+  s[2] ^= s[0];
+  s[3] ^= s[1];
+  s[1] ^= s[2];
+  s[0] ^= s[3];
+  s[2] ^= t;
+  s[3] = rotl(s[3], 45);
+  return result;
+}
+
+uint64_t Rng::below(uint64_t n) {
+  assert(n > 0);
+  /* Reject the values of the last incomplete block to avoid bias. */
+  uint64_t limit = max() - max() % n;
+  uint64_t x;
+  do {
+    x = (*this)();
+  } while (x >= limit);
+  return x % n;
+}
+
+double Rng::real() { return ((*this)() >> 11) / 9007199254740992.0; }
+
+void set_seed(uint64_t seed) {
+  global_seed = seed;
+  seed_generation++;
+}
+
+uint64_t get_seed() { return has_thread_seed ? thread_seed : global_seed.load(); }
+
+uint64_t derive_seed(uint64_t seed, uint64_t i) {
+  uint64_t x = seed ^ splitmix64(i);
+  return splitmix64(x);
+}
+
+void set_thread_seed(uint64_t seed) {
+  thread_seed = seed;
+  has_thread_seed = true;
+  thread_seed_generation++;
+}
+
+void clear_thread_seed() {
+  has_thread_seed = false;
+  thread_seed_generation++;
+}
+
+Rng &thread_rng() {
+  thread_local Rng rng;
+  thread_local unsigned generation = numeric_limits<unsigned>::max();
+  thread_local unsigned local_generation = 0;
+  unsigned current = seed_generation;
+  if (generation != current || local_generation != thread_seed_generation) {
+    int thread = 0;
+#ifdef _OPENMP
+    thread = omp_get_thread_num();
+#endif
+    rng = Rng(get_seed(), THREAD_STREAMS | thread);
+    generation = current;
+    local_generation = thread_seed_generation;
+  }
+  return rng;
+}
+
+Rng task_rng(uint64_t i) { return Rng(get_seed(), i & ~THREAD_STREAMS); }
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+
+/* Xoshiro256** pseudo random generator. It satisfies the requirements of a
+ * uniform random bit generator, so it can be used with the algorithms of the
+ * standard library (shuffle, distributions...). */
+class Rng {
+  uint64_t s[4];
+
+ public:
+  typedef uint64_t result_type;
+
+  Rng() : Rng(0, 0) {}
+  /* Generators with the same seed and different streams are independent. */
+  Rng(uint64_t seed, uint64_t stream);
+  static constexpr result_type min() { return 0; }
+  static constexpr result_type max() {
+    return std::numeric_limits<result_type>::max();
+  }
+  result_type operator()();
+  /* Uniform integer in [0, n) */
+  uint64_t below(uint64_t n);
+  /* Uniform real in [0, 1) */
+  double real();
+};
+
+/* Set the seed used to derive the generators of every thread. */
+void set_seed(uint64_t seed);
+/* Seed used by the calling thread. */
+uint64_t get_seed();
+/* Seed of the i-th of a sequence of independent runs (instances...) made
+ * from the given seed. */
+uint64_t derive_seed(uint64_t seed, uint64_t i);
+/* Make the generators of the calling thread use the given seed instead of
+ * the global one, until clear_thread_seed is called. Threads of nested
+ * parallel regions still use the global seed. */
+void set_thread_seed(uint64_t seed);
+void clear_thread_seed();
+/* Generator of the calling thread, its stream is the thread number. */
+Rng &thread_rng();
+/* Generator of the i-th task (iteration, instance...), independent of the
+ * thread generators and of the thread that runs the task. */
+Rng task_rng(uint64_t i);
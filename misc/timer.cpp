@@ -1,8 +1,9 @@
 #include <algorithm>
+#include <limits>
 #include "timer.hpp"
 using namespace std::chrono;
 
-Timer::Timer() {
+Timer::Timer(double limit) : limit(limit) {
 	begin = high_resolution_clock::now();
     mark = begin;
 }
@@ -18,7 +19,8 @@ double Timer::since_last_mark() {
 }
 
 double Timer::remaning_time() {
-	return std::max(0.0, MAX_RUNTIME - elapsed_time());
+	if (!has_limit()) return std::numeric_limits<double>::infinity();
+	return std::max(0.0, limit - elapsed_time());
 }
 
 double Timer::elapsed_time() {
@@ -28,6 +30,6 @@ double Timer::elapsed_time() {
 }
 
 bool Timer::done() {
-	if (elapsed_time() >= MAX_RUNTIME) return true;
+	if (has_limit() && elapsed_time() >= limit) return true;
 	else return false;
 }
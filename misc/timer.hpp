@@ -2,16 +2,16 @@
 
 #include <chrono>
 
-#define MAX_RUNTIME 100.0
-
 class Timer {
 	std::chrono::time_point<std::chrono::high_resolution_clock> begin;
 	std::chrono::time_point<std::chrono::high_resolution_clock> mark;
+	double limit; // time limit in seconds (0 if there is no limit)
 
 	public:
-	Timer();
+	Timer(double limit = 0);
     void mark_time();
     double since_last_mark();
+	bool has_limit() const { return limit > 0; }
 	double remaning_time();
 	double elapsed_time();
 	bool done();